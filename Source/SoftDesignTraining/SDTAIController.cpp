@@ -2,36 +2,321 @@
 
 #include "SDTAIController.h"
 #include "SoftDesignTraining.h"
+#include "SDTBenchmark.h"
 #include "SDTCollectible.h"
+#include "SDTCollectibleAssignment.h"
+#include "SDTCollectibleRegistry.h"
 #include "SDTFleeLocation.h"
+#include "SDTFleeTable.h"
+#include "SDTGameEvents.h"
+#include "SDTJumpTable.h"
+#include "SDTNavDistanceTable.h"
+#include "SDTPlayerDistanceField.h"
+#include "SDTSensingSubsystem.h"
+#include "SDTStats.h"
+#include "SDTUtilityScorer.h"
+#include "SDTVisibilitySubsystem.h"
+#include "SDTWorldSnapshot.h"
 #include "SDTPathFollowingComponent.h"
 #include "DrawDebugHelpers.h"
+#include "Components/LineBatchComponent.h"
 #include "Kismet/KismetMathLibrary.h"
 #include "NavigationSystem.h"
+#include "NavFilters/NavigationQueryFilter.h"
 #include "SDTUtils.h"
 #include "EngineUtils.h"
 #include "SoftDesignTrainingMainCharacter.h"
 
+#if !(UE_BUILD_SHIPPING || UE_BUILD_TEST)
+static TAutoConsoleVariable<int32> CVarShowNavigationPath(
+    TEXT("sdt.ShowNavigationPath"),
+    1,
+    TEXT("Draws the path followed by the AI pawns heading to a collectible.\n")
+    TEXT(" 0: off\n")
+    TEXT(" 1: on"),
+    ECVF_Cheat);
+#endif
+
+static TAutoConsoleVariable<int32> CVarPerceptionMode(
+    TEXT("sdt.Perception.Mode"),
+    0,
+    TEXT("How the AI pawns detect the player.\n")
+    TEXT(" 0: blocking sweep and visibility trace on every decision update\n")
+    TEXT(" 1: asynchronous sweep and visibility trace, results used on the next decision update\n")
+    TEXT(" 2: player sensing shared by all the pawns, computed once per frame"),
+    ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarPerceptionParityCheck(
+    TEXT("sdt.Perception.ParityCheck"),
+    0,
+    TEXT("When the asynchronous or shared perception is used, also runs the blocking queries and logs the decisions that do not match within one update."),
+    ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarChaseField(
+    TEXT("sdt.ChaseField"),
+    1,
+    TEXT("How the AI pawns chase the player.\n")
+    TEXT(" 0: path query to the player on every retarget\n")
+    TEXT(" 1: follow the player distance field shared by all the pawns, path to the player once close to it"),
+    ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarFleeField(
+    TEXT("sdt.FleeField"),
+    1,
+    TEXT("How the AI pawns flee the player.\n")
+    TEXT(" 0: flee table and a path query to the best flee location\n")
+    TEXT(" 1: walk up the player distance field toward the flee locations, the flee table is only the fallback"),
+    ECVF_Default);
+
 ASDTAIController::ASDTAIController(const FObjectInitializer& ObjectInitializer)
     : Super(ObjectInitializer.SetDefaultSubobjectClass<USDTPathFollowingComponent>(TEXT("PathFollowingComponent"))),
     m_currentObjective(PawnObjective::GetCollectibles)
 {
+    m_DetectionTraceDelegate.BindUObject(this, &ASDTAIController::OnDetectionTraceDone);
+    m_VisibilityTraceDelegate.BindUObject(this, &ASDTAIController::OnVisibilityTraceDone);
+}
+
+void ASDTAIController::BeginPlay()
+{
+    Super::BeginPlay();
+
+    if (USDTCollectibleRegistry* registry = GetWorld()->GetSubsystem<USDTCollectibleRegistry>())
+        m_AgentId = registry->RegisterAgent();
+
+    if (USDTJumpTable* jumpTable = GetWorld()->GetSubsystem<USDTJumpTable>())
+        m_JumpProfile = jumpTable->RegisterJumpProfile(JumpCurve, JumpApexHeight);
+
+    if (USDTGameEvents* events = GetWorld()->GetSubsystem<USDTGameEvents>())
+    {
+        m_CollectibleAvailabilityHandle = events->OnCollectibleAvailabilityChanged.AddUObject(this, &ASDTAIController::OnCollectibleAvailabilityChanged);
+        m_PowerUpHandle = events->OnPowerUpChanged.AddUObject(this, &ASDTAIController::OnPowerUpChanged);
+        m_CharacterDiedHandle = events->OnCharacterDied.AddUObject(this, &ASDTAIController::OnCharacterDied);
+    }
+    m_PlayerPoweredUp = SDTUtils::IsPlayerPoweredUp(GetWorld());
 }
 
-void ASDTAIController::GoToBestTarget(float deltaTime)
+void ASDTAIController::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
-    if      (m_currentObjective == PawnObjective::GetCollectibles) GoToBestCollectible();
-    else if (m_currentObjective == PawnObjective::ChasePlayer)     GoToPlayer();
-    else if (m_currentObjective == PawnObjective::EscapePlayer)    GoToBestFleeLocation();
+    if (USDTGameEvents* events = GetWorld()->GetSubsystem<USDTGameEvents>())
+    {
+        events->OnCollectibleAvailabilityChanged.Remove(m_CollectibleAvailabilityHandle);
+        events->OnPowerUpChanged.Remove(m_PowerUpHandle);
+        events->OnCharacterDied.Remove(m_CharacterDiedHandle);
+    }
+
+    if (USDTCollectibleRegistry* registry = GetWorld()->GetSubsystem<USDTCollectibleRegistry>())
+        registry->UnregisterAgent(m_AgentId);
+    m_AgentId = INDEX_NONE;
+
+    Super::EndPlay(EndPlayReason);
+}
+
+/*
+ * Stores what the compute phase needs: the perceived player, the state of the pawn and the shared world state
+ */
+void ASDTAIController::GatherDecisionInput(float deltaTime)
+{
+    SDT_SCOPE_CYCLE_STAT(GatherDecisionInput);
+
+    FDecisionInput& input = m_DecisionInput;
+    input.PerceptionUpdated = false;
+    input.VisiblePlayer = nullptr;
+
+    UpdatePlayerInteraction(deltaTime);
+
+    UWorld* world = GetWorld();
+    const USDTWorldSnapshotSubsystem* snapshots = world->GetSubsystem<USDTWorldSnapshotSubsystem>();
+    input.Snapshot = snapshots ? snapshots->GetSnapshot() : FSDTWorldSnapshotPtr();
+    input.Registry = world->GetSubsystem<USDTCollectibleRegistry>();
+    input.Assignment = world->GetSubsystem<USDTCollectibleAssignment>();
+    input.FleeTable = world->GetSubsystem<USDTFleeTable>();
+    input.DistanceTable = world->GetSubsystem<USDTNavDistanceTable>();
+    input.PlayerDistanceField = world->GetSubsystem<USDTPlayerDistanceField>();
+    input.AssignedCollectible = input.Assignment ? input.Assignment->GetAssignedCollectible(m_AgentId) : nullptr;
+
+    const APawn* pawn = GetPawn();
+    input.HasPawn = pawn != nullptr;
+    input.PawnLocation = pawn ? pawn->GetActorLocation() : FVector::ZeroVector;
+    input.TargetPlayer = m_targetPlayer;
+    input.Objective = m_currentObjective;
+    input.ReachedTarget = m_ReachedTarget;
+    input.PlayerPoweredUp = m_PlayerPoweredUp;
+    input.CanSearchCollectible = !m_WaitingForCollectible && m_CollectiblePathBatch.PendingCount == 0;
+}
+
+/*
+ * Chooses the objective and the target of the pawn from the gathered input only, so it can run on a worker thread
+ */
+void ASDTAIController::ComputeDecision()
+{
+    FDecisionCommand& command = m_DecisionCommand;
+    command.Objective = m_DecisionInput.Objective;
+    command.TargetPlayer = m_DecisionInput.TargetPlayer;
+    command.ForceRetarget = false;
+    command.Interrupt = false;
+    command.Action = FDecisionCommand::None;
+    command.Collectibles.Reset();
+    command.FleeLocations.Reset();
+
+    if (!m_DecisionInput.HasPawn || !m_DecisionInput.Snapshot)
+        return;
+
+    if (m_DecisionInput.PerceptionUpdated)
+        UpdateBehavior(m_DecisionInput, command);
+
+    if (m_DecisionInput.ReachedTarget || command.ForceRetarget || command.Interrupt)
+        ChooseTarget(m_DecisionInput, command);
+}
+
+void ASDTAIController::ApplyDecision(float deltaTime)
+{
+    const FDecisionCommand& command = m_DecisionCommand;
+    if (!GetPawn())
+        return;
+
+    m_targetPlayer = command.TargetPlayer;
+    m_currentObjective = command.Objective;
+    if (m_currentObjective == PawnObjective::ChasePlayer || m_currentObjective == PawnObjective::EscapePlayer)
+    {
+        if (USDTPlayerDistanceField* playerDistanceField = GetWorld()->GetSubsystem<USDTPlayerDistanceField>())
+            playerDistanceField->RequestField();
+    }
+    if (command.ForceRetarget)
+        m_ReachedTarget = true;
+    if (command.Interrupt)
+        AIStateInterrupted();
+
+    switch (command.Action)
+    {
+    case FDecisionCommand::EvaluateCollectibles: GoToBestCollectible(command.Collectibles); break;
+    case FDecisionCommand::WaitForCollectible:   m_WaitingForCollectible = true; break;
+    case FDecisionCommand::MoveToPlayer:         GoToPlayer(command.MoveLocation, command.UsePathfinding); break;
+    case FDecisionCommand::FleeFromPlayer:       GoToBestFleeLocation(command.FleeLocations, command.PlayerLocation); break;
+    case FDecisionCommand::FleeAlongField:       GoToFleeWaypoint(command.MoveLocation); break;
+    default: break;
+    }
+
+    m_DecisionInput.Snapshot.Reset();
+}
+
+/*
+ * Picks the candidate targets of the objective, the path queries are left to the apply phase
+ */
+void ASDTAIController::ChooseTarget(const FDecisionInput& input, FDecisionCommand& command) const
+{
+    SDT_SCOPE_CYCLE_STAT(ChooseTarget);
+
+    const FSDTWorldSnapshot& snapshot = *input.Snapshot;
+
+    if (command.Objective == PawnObjective::GetCollectibles)
+    {
+        // an evaluation is already pending, or there is nothing to collect until a collectible becomes available
+        if (!input.Registry || (!input.CanSearchCollectible && !command.Interrupt))
+            return;
+
+        // follow the global assignment when it has a collectible for this pawn, otherwise only consider the available collectibles nearest to the pawn.
+        // The collectibles are only identities here: they are looked up in the slots and locations of the snapshot.
+        const int32 assignedSlot = snapshot.FindCollectibleSlot(input.AssignedCollectible);
+        if (assignedSlot != INDEX_NONE && snapshot.CollectibleAvailable[assignedSlot] && !input.Registry->IsSlotClaimedByOther(assignedSlot, m_AgentId))
+            command.Collectibles.Add(input.AssignedCollectible);
+
+        if (command.Collectibles.Num() == 0)
+        {
+            TArray<int32> nearestSlots;
+            input.Registry->GetNearestAvailable(input.PawnLocation, snapshot.CollectibleLocations, m_CollectibleCandidateCount, nearestSlots);
+            for (int32 slot : nearestSlots)
+            {
+                if (snapshot.CollectibleAvailable[slot] && snapshot.Collectibles[slot])
+                    command.Collectibles.Add(snapshot.Collectibles[slot]);
+            }
+            PrefilterCollectibles(input, command.Collectibles);
+        }
+
+        command.Action = command.Collectibles.Num() > 0 ? FDecisionCommand::EvaluateCollectibles : FDecisionCommand::WaitForCollectible;
+    }
+    else if (command.Objective == PawnObjective::ChasePlayer && snapshot.HasPlayer())
+    {
+        command.Action = FDecisionCommand::MoveToPlayer;
+        command.PlayerLocation = snapshot.PlayerLocation;
+
+        // steer along the shared player distance field, the pawns near the player still path to it
+        command.UsePathfinding = !(CVarChaseField.GetValueOnAnyThread() != 0 && input.PlayerDistanceField
+            && input.PlayerDistanceField->GetChaseTarget(input.PawnLocation, snapshot.PlayerLocation, command.MoveLocation));
+        if (command.UsePathfinding)
+            command.MoveLocation = snapshot.PlayerLocation;
+    }
+    else if (command.Objective == PawnObjective::EscapePlayer && snapshot.HasPlayer() && CVarFleeField.GetValueOnAnyThread() != 0
+        && input.PlayerDistanceField && input.PlayerDistanceField->GetFleeTarget(input.PawnLocation, snapshot.PlayerLocation, command.MoveLocation))
+    {
+        // flee along the shared player distance field, the pawns it does not cover fall back to the flee table
+        command.Action = FDecisionCommand::FleeAlongField;
+        command.PlayerLocation = snapshot.PlayerLocation;
+    }
+    else if (command.Objective == PawnObjective::EscapePlayer && snapshot.HasPlayer() && input.FleeTable)
+    {
+        // the best flee location is confirmed with a path query when applied, the next one is the fallback
+        input.FleeTable->GetSafeFleeLocations(input.PawnLocation, snapshot.PlayerLocation, 45.0f, 2, command.FleeLocations);
+        if (command.FleeLocations.Num() > 0)
+        {
+            command.Action = FDecisionCommand::FleeFromPlayer;
+            command.PlayerLocation = snapshot.PlayerLocation;
+        }
+    }
+}
+
+/*
+ * Keeps the collectibles nearest to the pawn by the navmesh distance table, dropping the unreachable ones,
+ * so only a few of them need a path query.
+ * The collectibles the table does not know yet are kept, ranked by their straight line distance which is never longer than the navmesh one.
+ */
+void ASDTAIController::PrefilterCollectibles(const FDecisionInput& input, TArray<const ASDTCollectible*>& inOutCollectibles) const
+{
+    const USDTNavDistanceTable* distanceTable = input.DistanceTable;
+    if (!distanceTable || !distanceTable->IsBuilt() || inOutCollectibles.Num() <= m_CollectiblePathQueryCount)
+        return;
+
+    const int32 anchor = distanceTable->FindAnchor(input.PawnLocation);
+    if (anchor == INDEX_NONE)
+        return;
+
+    const FSDTWorldSnapshot& snapshot = *input.Snapshot;
+
+    FSDTUtilityCandidates candidates;
+    candidates.Reset(inOutCollectibles.Num());
+    for (int32 i = 0; i < inOutCollectibles.Num(); ++i)
+    {
+        const float distance = distanceTable->GetDistance(input.PawnLocation, anchor, distanceTable->GetPointOfInterestIndex(inOutCollectibles[i]));
+        const int32 slot = snapshot.FindCollectibleSlot(inOutCollectibles[i]);
+        const float estimate = distance >= 0.f ? distance : FVector::Dist(input.PawnLocation, snapshot.CollectibleLocations[slot]);
+        candidates.SetValue(i, estimate);
+        candidates.SetFlag(i, FSDTUtilityCandidates::Available, distance != MAX_FLT);
+    }
+
+    FSDTUtilityScorer scorer;
+    scorer.AddValue(-1.f).Require(FSDTUtilityCandidates::Available);
+
+    TArray<int32> nearestIndices;
+    scorer.SelectTopK(candidates, FMath::Max(1, m_CollectiblePathQueryCount), nearestIndices);
+
+    TArray<const ASDTCollectible*> nearestCollectibles;
+    nearestCollectibles.Reserve(nearestIndices.Num());
+    for (int32 index : nearestIndices)
+    {
+        nearestCollectibles.Add(inOutCollectibles[index]);
+    }
+    inOutCollectibles = MoveTemp(nearestCollectibles);
 }
 
 /*
  * Moves the pawn to the best flee location
  */
-void ASDTAIController::GoToBestFleeLocation()
+void ASDTAIController::GoToBestFleeLocation(const TArray<ASDTFleeLocation*>& fleeLocations, const FVector& playerLoc)
 {
-    if (AActor* bestFleeLocation = GetBestFleeLocation())
+    SDT_SCOPE_CYCLE_STAT(GoToBestFleeLocation);
+
+    if (AActor* bestFleeLocation = GetBestFleeLocation(fleeLocations, playerLoc))
     {
+        SDT_INC_COUNTER_STAT(PathQueries, 1);
         MoveToLocation(bestFleeLocation->GetActorLocation(), -1.0f, true, true, true, true, 0, false);
         OnMoveToTarget(bestFleeLocation);
     }
@@ -41,104 +326,189 @@ void ASDTAIController::GoToBestFleeLocation()
  * Finds and returns the best flee location
  * A flee location is better than another one if it is further from the player.
  * A flee location is acceptable if the trajectory to join it does not cross the player's path.
+ * The flee table gave the acceptable flee locations from the pawn region, only the best one is confirmed with a path query.
  */
-AActor* ASDTAIController::GetBestFleeLocation()
+AActor* ASDTAIController::GetBestFleeLocation(const TArray<ASDTFleeLocation*>& fleeLocations, const FVector& playerLoc)
 {
-    // get all flee locations
-    TArray<AActor*> fleeLocations;
-    UGameplayStatics::GetAllActorsOfClass(GetWorld(), ASDTFleeLocation::StaticClass(), fleeLocations);
+    SDT_BENCHMARK_SCOPE(GetBestFleeLocation);
+    SDT_SCOPE_CYCLE_STAT(GetBestFleeLocation);
 
-    // sort flee locations by distance to the target player
-    fleeLocations.Sort([&](const AActor& fleeLoc1, const AActor& fleeLoc2) {
-        const float fleeDist1 = FVector::DistSquared2D(m_targetPlayer->GetActorLocation(), fleeLoc1.GetActorLocation());
-        const float fleeDist2 = FVector::DistSquared2D(m_targetPlayer->GetActorLocation(), fleeLoc2.GetActorLocation());
-        return fleeDist1 > fleeDist2;
-    });
+    if (fleeLocations.Num() == 0)
+        return nullptr;
 
-    // select the first flee location path that does not cross the target player
-    AActor* bestFleelocation = nullptr;
-    auto navSystem = FNavigationSystem::GetCurrent<UNavigationSystemV1>(this);
+    const FVector pawnLoc = GetPawn()->GetActorLocation();
 
-    for (auto fleeLoc : fleeLocations)
+    // confirm the best flee location with the pawn's actual path, the next one is trusted as is
+    auto navSystem = FNavigationSystem::GetCurrent<UNavigationSystemV1>(this);
+    SDT_INC_COUNTER_STAT(PathQueries, 1);
+    auto path = navSystem->FindPathToLocationSynchronously(GetWorld(), pawnLoc, fleeLocations[0]->GetActorLocation());
+    if (path->PathPoints.Num() >= 2)
     {
-        auto path = navSystem->FindPathToLocationSynchronously(GetWorld(), GetPawn()->GetActorLocation(), fleeLoc->GetActorLocation());
-        if (path->PathPoints.Num() >= 2)
-        {
-            const FVector pawnLoc = GetPawn()->GetActorLocation();
-            const FVector fleeDir = (path->PathPoints[1] - pawnLoc).GetSafeNormal();
-            const FVector pawnToPlayer = (m_targetPlayer->GetActorLocation() - pawnLoc).GetSafeNormal();
-            const bool pathCrossesPlayer = FMath::RadiansToDegrees(std::acos(FVector::DotProduct(fleeDir, pawnToPlayer))) <= 45.0f;
+        const FVector fleeDir = (path->PathPoints[1] - pawnLoc).GetSafeNormal();
+        const FVector pawnToPlayer = (playerLoc - pawnLoc).GetSafeNormal();
+        const bool pathCrossesPlayer = FVector::DotProduct(fleeDir, pawnToPlayer) >= FMath::Cos(FMath::DegreesToRadians(45.0f));
 
-            if (!pathCrossesPlayer)
-            {
-                bestFleelocation = fleeLoc;
-                break;
-            }
-        }
+        if (!pathCrossesPlayer)
+            return fleeLocations[0];
     }
-    return bestFleelocation;
+    return fleeLocations.Num() >= 2 ? fleeLocations[1] : nullptr;
+}
+
+/*
+ * Moves the pawn straight to the next waypoint of the player distance field, away from the player
+ */
+void ASDTAIController::GoToFleeWaypoint(const FVector& waypoint)
+{
+    SDT_SCOPE_CYCLE_STAT(GoToBestFleeLocation);
+
+    MoveToLocation(waypoint, -1.0f, true, false, true, true, 0, false);
+    OnMoveToTarget(nullptr);
 }
 
 /*
- * Moves the pawn straight to the target player
+ * Moves the pawn toward the target player, either to the player itself or to the next waypoint of the player distance field
  */
-void ASDTAIController::GoToPlayer()
+void ASDTAIController::GoToPlayer(const FVector& moveLocation, bool usePathfinding)
 {
-    MoveToLocation(m_targetPlayer->GetActorLocation(), -1.0f, true, true, true, true, 0, false);
+    SDT_SCOPE_CYCLE_STAT(GoToPlayer);
+
+    SDT_INC_COUNTER_STAT(PathQueries, usePathfinding ? 1 : 0);
+    MoveToLocation(moveLocation, -1.0f, true, usePathfinding, true, true, 0, false);
     OnMoveToTarget(m_targetPlayer);
 }
 
 /*
- * Moves the pawn to the nearest collectible
+ * Starts the evaluation of the candidate collectibles chosen by the compute phase.
+ * One path query per candidate is sent to the navigation system, which solves them on worker threads.
+ * The pawn keeps following its current path until all the results are back (see OnCollectiblePathFound).
  */
-void ASDTAIController::GoToBestCollectible()
+void ASDTAIController::GoToBestCollectible(const TArray<const ASDTCollectible*>& candidates)
 {
-    TArray<AActor*> targetActors;
+    SDT_BENCHMARK_SCOPE(GoToBestCollectible);
+    SDT_SCOPE_CYCLE_STAT(GoToBestCollectible);
+
+    if (m_CollectiblePathBatch.PendingCount > 0 || candidates.Num() == 0)
+        return;
+
+    UNavigationSystemV1* navSystem = FNavigationSystem::GetCurrent<UNavigationSystemV1>(this);
+    if (!navSystem)
+        return;
+
+    const ANavigationData* navData = navSystem->GetNavDataForProps(GetNavAgentPropertiesRef());
+    if (!navData)
+        return;
 
-    // find all collectibles in the level
-    UGameplayStatics::GetAllActorsOfClass(GetWorld(), ASDTCollectible::StaticClass(), targetActors);
+    const uint32 batchId = ++m_CollectiblePathBatch.Id;
+    m_CollectiblePathBatch.PendingCount = candidates.Num();
+    m_CollectiblePathBatch.Candidates.Reset(candidates.Num());
+    m_CollectiblePathBatch.Paths.Reset(candidates.Num());
 
-    // find nearest actor
-    float minDistance = MAX_FLT;
-    AActor* targetActor = nullptr;
+    FSharedConstNavQueryFilter queryFilter = UNavigationQueryFilter::GetQueryFilter(*navData, this, GetDefaultNavigationFilterClass());
 
-    for (AActor* actor : targetActors)
+    for (int32 i = 0; i < candidates.Num(); ++i)
     {
-        float distanceToTarget = 0.0f;
+        m_CollectiblePathBatch.Candidates.Add(candidates[i]);
+        m_CollectiblePathBatch.Paths.Add(nullptr);
+
+        // a single search gives both the length and the partial state of the path
+        FPathFindingQuery query(this, *navData, GetPawn()->GetActorLocation(), candidates[i]->GetActorLocation(), queryFilter);
+        SDT_INC_COUNTER_STAT(PathQueries, 1);
+        navSystem->FindPathAsync(GetNavAgentPropertiesRef(), query, FNavPathQueryDelegate::CreateUObject(this, &ASDTAIController::OnCollectiblePathFound, i, batchId));
+    }
+}
 
-        // check if the distance to the target is partial
-        const UNavigationSystemV1* navSystem = FNavigationSystem::GetCurrent<UNavigationSystemV1>(this);
-        navSystem->GetPathLength(GetPawn()->GetActorLocation(), actor->GetActorLocation(), distanceToTarget);
-        const bool distanceIsPartial = navSystem->FindPathToLocationSynchronously(GetWorld(), GetPawn()->GetActorLocation(), actor->GetActorLocation())->IsPartial();
+void ASDTAIController::OnCollectiblePathFound(uint32 queryId, ENavigationQueryResult::Type result, FNavPathSharedPtr path, int32 candidateIndex, uint32 batchId)
+{
+    // the evaluation was cancelled or replaced
+    if (batchId != m_CollectiblePathBatch.Id || m_CollectiblePathBatch.PendingCount <= 0)
+        return;
 
-        // check if target is visible
-        ASDTCollectible* collectible = Cast<ASDTCollectible>(actor);
-        const bool targetIsVisible = collectible->GetStaticMeshComponent()->IsVisible();
+    if (result == ENavigationQueryResult::Success && path.IsValid() && path->IsValid() && !path->IsPartial())
+        m_CollectiblePathBatch.Paths[candidateIndex] = path;
 
-        // check if no other pawn is already heading towards this
-        const bool collectibleIsTargeted = !collectible->m_currentSeeker.IsEmpty() && collectible->m_currentSeeker != GetPawn()->GetActorLabel();
+    if (--m_CollectiblePathBatch.PendingCount == 0)
+        ApplyCollectiblePathBatch();
+}
 
-        if (distanceToTarget < minDistance && !distanceIsPartial && targetIsVisible && !collectibleIsTargeted) {
-            targetActor = actor;
-            minDistance = distanceToTarget;
-            collectible->SetCurrentSeeker(GetPawn()->GetActorLabel()); // tell the other pawns that this one is ours
-        }
+/*
+ * Moves the pawn to the nearest collectible of the completed evaluation, reusing the path found for it
+ */
+void ASDTAIController::ApplyCollectiblePathBatch()
+{
+    SDT_SCOPE_CYCLE_STAT(ApplyCollectiblePathBatch);
+
+    // the objective may have changed while the queries were running
+    if (m_currentObjective != PawnObjective::GetCollectibles || !m_ReachedTarget || !GetPawn())
+        return;
+
+    USDTCollectibleRegistry* registry = GetWorld()->GetSubsystem<USDTCollectibleRegistry>();
+    const FSDTWorldSnapshotPtr snapshot = GetWorldSnapshot();
+    if (!registry || !snapshot)
+        return;
+
+    // the nearest collectible by path length that no other pawn is already heading towards
+    const int32 candidateCount = m_CollectiblePathBatch.Candidates.Num();
+    FSDTUtilityCandidates candidates;
+    candidates.Reset(candidateCount);
+
+    for (int32 i = 0; i < candidateCount; ++i)
+    {
+        const ASDTCollectible* collectible = m_CollectiblePathBatch.Candidates[i].Get();
+        const FNavPathSharedPtr& path = m_CollectiblePathBatch.Paths[i];
+        const bool available = collectible && path.IsValid() && snapshot->IsCollectibleAvailable(collectible);
+
+        candidates.SetFlag(i, FSDTUtilityCandidates::Available, available);
+        candidates.SetFlag(i, FSDTUtilityCandidates::Unreserved, available && !registry->IsClaimedByOther(collectible, m_AgentId));
+        candidates.SetValue(i, available ? path->GetLength() : 0.f);
     }
 
-    // move the pawn to the collectible
-    if (targetActor) {
-        MoveToLocation(targetActor->GetActorLocation(), -1.0f, true, true, true, true, 0, false);
-        OnMoveToTarget(targetActor);
+    FSDTUtilityScorer scorer;
+    scorer.AddValue(-1.f).Require(FSDTUtilityCandidates::Available).Require(FSDTUtilityCandidates::Unreserved);
+
+    TArray<int32> bestIndices;
+    scorer.SelectTopK(candidates, 1, bestIndices);
+
+    // move the pawn to the collectible, the candidates come from the snapshot and the registry gives the collectible back to the game thread
+    const int32 bestIndex = bestIndices.Num() > 0 ? bestIndices[0] : INDEX_NONE;
+    if (ASDTCollectible* collectible = bestIndex != INDEX_NONE ? registry->FindCollectible(m_CollectiblePathBatch.Candidates[bestIndex].Get()) : nullptr)
+    {
+        // tell the other pawns that this one is ours
+        OnMoveToTarget(collectible);
+        registry->ClaimCollectible(collectible, m_AgentId);
+
+        FNavPathSharedPtr path = m_CollectiblePathBatch.Paths[bestIndex];
+        path->EnableRecalculationOnInvalidation(true);
+
+        FAIMoveRequest moveRequest(collectible->GetActorLocation());
+        moveRequest.SetAllowPartialPath(false);
+        moveRequest.SetCanStrafe(true);
+        RequestMove(moveRequest, path);
     }
+
+    CancelCollectiblePathBatch();
+}
+
+void ASDTAIController::CancelCollectiblePathBatch()
+{
+    ++m_CollectiblePathBatch.Id;
+    m_CollectiblePathBatch.PendingCount = 0;
+    m_CollectiblePathBatch.Candidates.Reset();
+    m_CollectiblePathBatch.Paths.Reset();
 }
 
 void ASDTAIController::OnMoveToTarget(AActor* targetActor)
 {
-    if (ASDTCollectible* collectible = Cast<ASDTCollectible>(m_TargetActor)) collectible->ResetCurrentSeeker();
+    SDT_INC_COUNTER_STAT(Retargets, 1);
+    ReleaseCollectibleClaim();
     m_ReachedTarget = false;
     m_TargetActor = targetActor;
 }
 
+ASDTCollectible* ASDTAIController::GetCollectibleTarget() const
+{
+    return m_ReachedTarget ? nullptr : Cast<ASDTCollectible>(m_TargetActor);
+}
+
 void ASDTAIController::OnMoveCompleted(FAIRequestID RequestID, const FPathFollowingResult& Result)
 {
     Super::OnMoveCompleted(RequestID, Result);
@@ -146,31 +516,65 @@ void ASDTAIController::OnMoveCompleted(FAIRequestID RequestID, const FPathFollow
     m_ReachedTarget = true;
 }
 
+/*
+ * Pawns interacting with the player, then pawns without a target, get their decisions updated first
+ */
+float ASDTAIController::GetUpdatePriority() const
+{
+    if (m_currentObjective == PawnObjective::ChasePlayer || m_currentObjective == PawnObjective::EscapePlayer)
+        return 2.f;
+
+    return m_ReachedTarget ? 1.f : 0.f;
+}
+
+/*
+ * Draws the remaining part of the path followed by the pawn, as held by the path following component
+ */
 void ASDTAIController::ShowNavigationPath()
 {
+#if !(UE_BUILD_SHIPPING || UE_BUILD_TEST)
+    SDT_SCOPE_CYCLE_STAT(ShowNavigationPath);
+
+    if (CVarShowNavigationPath.GetValueOnGameThread() == 0)
+        return;
+
     if (m_TargetActor && m_currentObjective == PawnObjective::GetCollectibles)
     {
-        // Get the current path
-        auto navSystem = FNavigationSystem::GetCurrent<UNavigationSystemV1>(this);
-        auto path = navSystem->FindPathToLocationSynchronously(GetWorld(), GetPawn()->GetActorLocation(), m_TargetActor->GetActorLocation());
+        const UPathFollowingComponent* pathFollowing = GetPathFollowingComponent();
+        ULineBatchComponent* lineBatcher = GetWorld()->LineBatcher;
+        if (!pathFollowing || !lineBatcher || !pathFollowing->GetPath().IsValid())
+            return;
+
+        const TArray<FNavPathPoint>& pathPoints = pathFollowing->GetPath()->GetPathPoints();
+
+        // Submit a line between all remaining points on the path in a single batch
+        TArray<FBatchedLine> lines;
+        lines.Reserve(pathPoints.Num());
 
-        // Draw a line between all points on the path
         FVector previousPoint = GetPawn()->GetActorLocation();
-        for (FVector point : path->PathPoints)
+        for (int32 i = pathFollowing->GetNextPathIndex(); i < pathPoints.Num(); ++i)
         {
-            DrawDebugLine(GetWorld(), previousPoint, point, FColor::Red);
-            previousPoint = point;
+            lines.Emplace(previousPoint, pathPoints[i].Location, FLinearColor(FColor::Red), lineBatcher->DefaultLifeTime, 0.f, SDPG_World);
+            previousPoint = pathPoints[i].Location;
         }
+        lineBatcher->DrawLines(lines);
     }
+#endif
 }
 
-void ASDTAIController::ChooseBehavior(float deltaTime)
-{
-    UpdatePlayerInteraction(deltaTime);
-}
-
+/*
+ * Runs the perception of the pawn and stores the visible player, if any, for the compute phase
+ */
 void ASDTAIController::UpdatePlayerInteraction(float deltaTime)
 {
+    SDT_BENCHMARK_SCOPE(UpdatePlayerInteraction);
+    SDT_SCOPE_CYCLE_STAT(UpdatePlayerInteraction);
+
+    auto setVisiblePlayer = [this](AActor* visiblePlayer) {
+        m_DecisionInput.PerceptionUpdated = true;
+        m_DecisionInput.VisiblePlayer = visiblePlayer;
+    };
+
     //finish jump before updating AI state
     if (AtJumpSegment)
         return;
@@ -179,81 +583,227 @@ void ASDTAIController::UpdatePlayerInteraction(float deltaTime)
     if (!selfPawn)
         return;
 
-    ACharacter* playerCharacter = UGameplayStatics::GetPlayerCharacter(GetWorld(), 0);
-    if (!playerCharacter)
+    const FSDTWorldSnapshotPtr snapshot = GetWorldSnapshot();
+    if (!snapshot || !snapshot->HasPlayer())
         return;
 
     FVector detectionStartLocation = selfPawn->GetActorLocation() + selfPawn->GetActorForwardVector() * m_DetectionCapsuleForwardStartingOffset;
     FVector detectionEndLocation = detectionStartLocation + selfPawn->GetActorForwardVector() * m_DetectionCapsuleHalfLength * 2;
 
-	//Detects all collisions between collectibles and players with the AI within the vision capsule.
-    TArray<TEnumAsByte<EObjectTypeQuery>> detectionTraceObjectTypes;
-    detectionTraceObjectTypes.Add(UEngineTypes::ConvertToObjectType(COLLISION_COLLECTIBLE));
-    detectionTraceObjectTypes.Add(UEngineTypes::ConvertToObjectType(COLLISION_PLAYER));
+    const int32 perceptionMode = CVarPerceptionMode.GetValueOnGameThread();
+    const bool parityCheck = perceptionMode != 0 && CVarPerceptionParityCheck.GetValueOnGameThread() != 0;
 
-    TArray<FHitResult> allDetectionHits;
-    GetWorld()->SweepMultiByObjectType(allDetectionHits, detectionStartLocation, detectionEndLocation, FQuat::Identity, detectionTraceObjectTypes, FCollisionShape::MakeSphere(m_DetectionCapsuleRadius));
+    AActor* syncVisiblePlayer = nullptr;
+    if (perceptionMode == 0 || parityCheck)
+    {
+        FHitResult detectionHit;
+        DetectInVisionCapsule(detectionStartLocation, detectionEndLocation, detectionHit);
+        syncVisiblePlayer = GetVisiblePlayer(detectionHit);
+    }
 
-    FHitResult detectionHit;
-    GetHightestPriorityDetectionHit(allDetectionHits, detectionHit);
+    if (perceptionMode == 2)
+    {
+        //Use the player sensing shared by all the pawns
+        USDTSensingSubsystem* sensing = GetWorld()->GetSubsystem<USDTSensingSubsystem>();
+        AActor* sensedVisiblePlayer = sensing ? sensing->GetVisiblePlayer(this) : nullptr;
+
+        if (parityCheck)
+            CheckPerceptionParity(syncVisiblePlayer != nullptr, sensedVisiblePlayer != nullptr);
 
-    //Set behavior based on hit
-    UpdateBehavior(detectionHit);
+        setVisiblePlayer(sensedVisiblePlayer);
+    }
+    else if (perceptionMode == 1)
+    {
+        //Use the traces requested on a previous update, then request the next ones
+        if (m_AsyncPerception.ResultReady)
+        {
+            AActor* asyncVisiblePlayer = ConsumeAsyncPerception();
+
+            if (parityCheck)
+                CheckPerceptionParity(syncVisiblePlayer != nullptr, asyncVisiblePlayer != nullptr);
+
+            setVisiblePlayer(asyncVisiblePlayer);
+        }
+
+        if (m_AsyncPerception.PendingTraces == 0)
+            RequestAsyncPerception(detectionStartLocation, detectionEndLocation, snapshot->PlayerLocation);
+    }
+    else
+    {
+        //Set behavior based on hit
+        setVisiblePlayer(syncVisiblePlayer);
+    }
     
     // draw the pawn vision capsule
     DrawDebugCapsule(GetWorld(), detectionStartLocation + m_DetectionCapsuleHalfLength * selfPawn->GetActorForwardVector(), m_DetectionCapsuleHalfLength, m_DetectionCapsuleRadius, selfPawn->GetActorQuat() * selfPawn->GetActorUpVector().ToOrientationQuat(), FColor::Blue);
 }
 
 /*
- * Updates the pawn state depending on the detection hit results
+ * Sweeps the vision capsule and returns the most important collectible or player found in it
  */
-void ASDTAIController::UpdateBehavior(FHitResult detectionHit)
+void ASDTAIController::DetectInVisionCapsule(const FVector& detectionStartLocation, const FVector& detectionEndLocation, FHitResult& outDetectionHit)
+{
+    SDT_SCOPE_CYCLE_STAT(DetectInVisionCapsule);
+
+	//Detects all collisions between collectibles and players with the AI within the vision capsule.
+    TArray<FHitResult> allDetectionHits;
+    SDT_INC_COUNTER_STAT(Traces, 1);
+    GetWorld()->SweepMultiByObjectType(allDetectionHits, detectionStartLocation, detectionEndLocation, FQuat::Identity, GetDetectionObjectQueryParams(), FCollisionShape::MakeSphere(m_DetectionCapsuleRadius));
+
+    GetHightestPriorityDetectionHit(allDetectionHits, outDetectionHit);
+}
+
+FCollisionObjectQueryParams ASDTAIController::GetDetectionObjectQueryParams()
+{
+    TArray<TEnumAsByte<EObjectTypeQuery>> detectionTraceObjectTypes;
+    detectionTraceObjectTypes.Add(UEngineTypes::ConvertToObjectType(COLLISION_COLLECTIBLE));
+    detectionTraceObjectTypes.Add(UEngineTypes::ConvertToObjectType(COLLISION_PLAYER));
+
+    return FCollisionObjectQueryParams(detectionTraceObjectTypes);
+}
+
+/*
+ * Returns the player detected by the hit if it is directly visible to the pawn
+ */
+AActor* ASDTAIController::GetVisiblePlayer(const FHitResult& detectionHit)
 {
-    const PawnObjective oldObjective = m_currentObjective;
     const UPrimitiveComponent* component = detectionHit.GetComponent();
-    bool foundVisiblePlayer = false;
+    if (component && component->GetCollisionObjectType() == COLLISION_PLAYER && TargetIsVisible(component->GetComponentLocation()))
+        return detectionHit.GetActor();
+
+    return nullptr;
+}
+
+/*
+ * Requests the vision capsule sweep and the player visibility trace to the physics async trace pass.
+ * Their results are delivered at the start of the next frame and used by the next decision update.
+ * The baked static visibility answers first like for TargetIsVisible, the visibility trace is only requested when it does not know.
+ */
+void ASDTAIController::RequestAsyncPerception(const FVector& detectionStartLocation, const FVector& detectionEndLocation, const FVector& playerLocation)
+{
+    SDT_SCOPE_CYCLE_STAT(RequestAsyncPerception);
 
-    if (component)
+    const USDTVisibilitySubsystem* visibility = GetWorld()->GetSubsystem<USDTVisibilitySubsystem>();
+    const ESDTStaticVisibility staticVisibility = visibility ? visibility->QueryLineOfSight(GetPawn()->GetActorLocation(), playerLocation) : ESDTStaticVisibility::Unknown;
+    const bool traceVisibility = staticVisibility == ESDTStaticVisibility::Unknown;
+
+    const uint32 requestId = ++m_AsyncPerception.RequestId;
+    m_AsyncPerception.PendingTraces = traceVisibility ? 2 : 1;
+    m_AsyncPerception.ResultReady = false;
+    m_AsyncPerception.DetectionHit = FHitResult();
+    m_AsyncPerception.PlayerIsBlocked = staticVisibility != ESDTStaticVisibility::Visible;
+
+    SDT_INC_COUNTER_STAT(Traces, m_AsyncPerception.PendingTraces);
+    GetWorld()->AsyncSweepByObjectType(EAsyncTraceType::Multi, detectionStartLocation, detectionEndLocation, FQuat::Identity, GetDetectionObjectQueryParams(),
+        FCollisionShape::MakeSphere(m_DetectionCapsuleRadius), FCollisionQueryParams::DefaultQueryParam, &m_DetectionTraceDelegate, requestId);
+
+    // same query as SDTUtils::Raycast
+    if (traceVisibility)
     {
-        const bool foundPlayer = component->GetCollisionObjectType() == COLLISION_PLAYER;
-        const bool playerIsVisible = TargetIsVisible(component->GetComponentLocation());
-        foundVisiblePlayer = foundPlayer && playerIsVisible;
+        GetWorld()->AsyncLineTraceByChannel(EAsyncTraceType::Single, GetPawn()->GetActorLocation(), playerLocation, COLLISION_LINE_OF_SIGHT,
+            SDTUtils::GetLineOfSightParams(), FCollisionResponseParams::DefaultResponseParam, &m_VisibilityTraceDelegate, requestId);
+    }
+}
 
-        if (foundVisiblePlayer)
-        {
-            const bool playerIsPoweredUp = SDTUtils::IsPlayerPoweredUp(GetWorld());
+void ASDTAIController::OnDetectionTraceDone(const FTraceHandle& traceHandle, FTraceDatum& traceDatum)
+{
+    if (traceDatum.UserData != m_AsyncPerception.RequestId)
+        return;
 
-            if (playerIsPoweredUp)
-            {
-                if (m_currentObjective == PawnObjective::EscapePlayer) m_ReachedTarget = true;
-                else m_currentObjective = PawnObjective::EscapePlayer;
-            }
-            else
-            {
-                m_ReachedTarget = true;
-                m_currentObjective = PawnObjective::ChasePlayer;
-            }
+    GetHightestPriorityDetectionHit(traceDatum.OutHits, m_AsyncPerception.DetectionHit);
+    OnAsyncPerceptionTraceDone();
+}
+
+void ASDTAIController::OnVisibilityTraceDone(const FTraceHandle& traceHandle, FTraceDatum& traceDatum)
+{
+    if (traceDatum.UserData != m_AsyncPerception.RequestId)
+        return;
+
+    m_AsyncPerception.PlayerIsBlocked = traceDatum.OutHits.Num() > 0 && traceDatum.OutHits[0].bBlockingHit;
+    OnAsyncPerceptionTraceDone();
+}
+
+void ASDTAIController::OnAsyncPerceptionTraceDone()
+{
+    if (--m_AsyncPerception.PendingTraces == 0)
+        m_AsyncPerception.ResultReady = true;
+}
+
+AActor* ASDTAIController::ConsumeAsyncPerception()
+{
+    SDT_SCOPE_CYCLE_STAT(ConsumeAsyncPerception);
+
+    m_AsyncPerception.ResultReady = false;
+
+    const UPrimitiveComponent* component = m_AsyncPerception.DetectionHit.GetComponent();
+    if (component && component->GetCollisionObjectType() == COLLISION_PLAYER && !m_AsyncPerception.PlayerIsBlocked)
+        return m_AsyncPerception.DetectionHit.GetActor();
+
+    return nullptr;
+}
+
+/*
+ * The asynchronous result comes from traces requested on the previous update,
+ * so it has to match either the current or the previous synchronous result.
+ * The shared sensing result is checked the same way.
+ */
+void ASDTAIController::CheckPerceptionParity(bool syncSeesPlayer, bool asyncSeesPlayer)
+{
+    if (asyncSeesPlayer != syncSeesPlayer && asyncSeesPlayer != m_PreviousSyncSeesPlayer)
+    {
+        ++m_PerceptionParityMismatchCount;
+        UE_LOG(LogSoftDesignTraining, Warning, TEXT("%s: perception mode %d %s the player, unlike the blocking queries (%d mismatches)"),
+            *GetName(), CVarPerceptionMode.GetValueOnGameThread(), asyncSeesPlayer ? TEXT("sees") : TEXT("does not see"), m_PerceptionParityMismatchCount);
+    }
+    m_PreviousSyncSeesPlayer = syncSeesPlayer;
+}
+
+/*
+ * Updates the pawn state depending on the visible player, if any
+ */
+void ASDTAIController::UpdateBehavior(const FDecisionInput& input, FDecisionCommand& command) const
+{
+    SDT_SCOPE_CYCLE_STAT(UpdateBehavior);
 
-            m_targetPlayer = detectionHit.GetActor();
+    AActor* visiblePlayer = input.VisiblePlayer;
+
+    if (visiblePlayer)
+    {
+        if (input.PlayerPoweredUp)
+        {
+            if (command.Objective == PawnObjective::EscapePlayer) command.ForceRetarget = true;
+            else command.Objective = PawnObjective::EscapePlayer;
+        }
+        else
+        {
+            command.ForceRetarget = true;
+            command.Objective = PawnObjective::ChasePlayer;
         }
+
+        command.TargetPlayer = visiblePlayer;
     }
     // get collectibles if nothing else to do
-    if (!foundVisiblePlayer && m_ReachedTarget) m_currentObjective = PawnObjective::GetCollectibles;
+    if (!visiblePlayer && (input.ReachedTarget || command.ForceRetarget)) command.Objective = PawnObjective::GetCollectibles;
 
     // interrupt if the objective changed
-    if (m_currentObjective != oldObjective) AIStateInterrupted();
+    if (command.Objective != input.Objective) command.Interrupt = true;
 }
 
 /*
  * Indicates if the specified location is directly visible to the pawn
+ * The baked static visibility answers first, the raycast is only done when it does not know.
  */
 bool ASDTAIController::TargetIsVisible(FVector targetLocation)
 {
-    return !SDTUtils::Raycast(GetWorld(), GetPawn()->GetActorLocation(), targetLocation);
+    SDT_SCOPE_CYCLE_STAT(TargetIsVisible);
+
+    return USDTVisibilitySubsystem::IsVisible(GetWorld(), GetPawn()->GetActorLocation(), targetLocation);
 }
 
 void ASDTAIController::GetHightestPriorityDetectionHit(const TArray<FHitResult>& hits, FHitResult& outDetectionHit)
 {
+    SDT_SCOPE_CYCLE_STAT(GetHightestPriorityDetectionHit);
+
     for (const FHitResult& hit : hits)
     {
         if (UPrimitiveComponent* component = hit.GetComponent())
@@ -274,6 +824,69 @@ void ASDTAIController::GetHightestPriorityDetectionHit(const TArray<FHitResult>&
 
 void ASDTAIController::AIStateInterrupted()
 {
+    CancelCollectiblePathBatch();
+    ReleaseCollectibleClaim();
     StopMovement();
     m_ReachedTarget = true;
-}
\ No newline at end of file
+}
+
+FSDTWorldSnapshotPtr ASDTAIController::GetWorldSnapshot() const
+{
+    const USDTWorldSnapshotSubsystem* snapshots = GetWorld()->GetSubsystem<USDTWorldSnapshotSubsystem>();
+    return snapshots ? snapshots->GetSnapshot() : FSDTWorldSnapshotPtr();
+}
+
+void ASDTAIController::ReleaseCollectibleClaim()
+{
+    if (USDTCollectibleRegistry* registry = GetWorld()->GetSubsystem<USDTCollectibleRegistry>())
+        registry->ReleaseClaim(m_AgentId);
+}
+
+/*
+ * Retargets when the collectible the pawn is heading to is taken, and stops waiting when one becomes available
+ */
+void ASDTAIController::OnCollectibleAvailabilityChanged(ASDTCollectible* collectible, bool available)
+{
+    if (available)
+    {
+        m_WaitingForCollectible = false;
+        return;
+    }
+
+    // the snapshot only sees the collectibles taken during this frame on the next one
+    const int32 candidateIndex = m_CollectiblePathBatch.Candidates.IndexOfByKey(collectible);
+    if (candidateIndex != INDEX_NONE)
+        m_CollectiblePathBatch.Candidates[candidateIndex] = nullptr;
+
+    if (collectible == m_TargetActor && !m_ReachedTarget && m_currentObjective == PawnObjective::GetCollectibles)
+    {
+        AIStateInterrupted();
+    }
+}
+
+/*
+ * Switches between chasing and escaping the player right away
+ */
+void ASDTAIController::OnPowerUpChanged(ASoftDesignTrainingMainCharacter* player, bool poweredUp)
+{
+    m_PlayerPoweredUp = poweredUp;
+
+    if (m_currentObjective == PawnObjective::ChasePlayer || m_currentObjective == PawnObjective::EscapePlayer)
+    {
+        m_currentObjective = poweredUp ? PawnObjective::EscapePlayer : PawnObjective::ChasePlayer;
+        AIStateInterrupted();
+    }
+}
+
+void ASDTAIController::OnCharacterDied(ASoftDesignTrainingCharacter* character)
+{
+    if (character == GetPawn())
+    {
+        AIStateInterrupted();
+    }
+    else if (character == m_targetPlayer && (m_currentObjective == PawnObjective::ChasePlayer || m_currentObjective == PawnObjective::EscapePlayer))
+    {
+        m_currentObjective = PawnObjective::GetCollectibles;
+        AIStateInterrupted();
+    }
+}
@@ -4,8 +4,21 @@
 
 #include "CoreMinimal.h"
 #include "SDTBaseAIController.h"
+#include "NavigationData.h"
+#include "WorldCollision.h"
+#include "SDTWorldSnapshot.h"
 #include "SDTAIController.generated.h"
 
+class ASDTCollectible;
+class ASDTFleeLocation;
+class USDTCollectibleAssignment;
+class USDTCollectibleRegistry;
+class USDTFleeTable;
+class USDTNavDistanceTable;
+class USDTPlayerDistanceField;
+class ASoftDesignTrainingCharacter;
+class ASoftDesignTrainingMainCharacter;
+
 /**
  * 
  */
@@ -17,6 +30,9 @@ class SOFTDESIGNTRAINING_API ASDTAIController : public ASDTBaseAIController
 public:
     ASDTAIController(const FObjectInitializer& ObjectInitializer = FObjectInitializer::Get());
 
+    virtual void BeginPlay() override;
+    virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = AI)
     float m_DetectionCapsuleHalfLength = 500.f;
 
@@ -26,6 +42,14 @@ public:
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = AI)
     float m_DetectionCapsuleForwardStartingOffset = 100.f;
 
+    // Number of nearest available collectibles considered when choosing a target
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = AI)
+    int32 m_CollectibleCandidateCount = 8;
+
+    // Number of those collectibles, nearest by the navmesh distance table, confirmed with a path query
+    UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = AI)
+    int32 m_CollectiblePathQueryCount = 3;
+
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = AI)
     UCurveFloat* JumpCurve;
 
@@ -54,23 +78,51 @@ public:
 
 public:
     virtual void OnMoveCompleted(FAIRequestID RequestID, const FPathFollowingResult& Result) override;
+    virtual float GetUpdatePriority() const override;
+    virtual void GatherDecisionInput(float deltaTime) override;
+    virtual void ComputeDecision() override;
+    virtual void ApplyDecision(float deltaTime) override;
     void AIStateInterrupted();
 
+    int32 GetAgentId() const { return m_AgentId; }
+    int32 GetJumpProfile() const { return m_JumpProfile; }
+    bool IsSeekingCollectible() const { return m_currentObjective == PawnObjective::GetCollectibles; }
+    ASDTCollectible* GetCollectibleTarget() const;
+
 protected:
     void OnMoveToTarget(AActor* targetActor);
     void GetHightestPriorityDetectionHit(const TArray<FHitResult>& hits, FHitResult& outDetectionHit);
     void UpdatePlayerInteraction(float deltaTime);
-    void UpdateBehavior(FHitResult detectionHit);
+
+    void DetectInVisionCapsule(const FVector& detectionStartLocation, const FVector& detectionEndLocation, FHitResult& outDetectionHit);
+    static FCollisionObjectQueryParams GetDetectionObjectQueryParams();
+    AActor* GetVisiblePlayer(const FHitResult& detectionHit);
+
+    void RequestAsyncPerception(const FVector& detectionStartLocation, const FVector& detectionEndLocation, const FVector& playerLocation);
+    void OnDetectionTraceDone(const FTraceHandle& traceHandle, FTraceDatum& traceDatum);
+    void OnVisibilityTraceDone(const FTraceHandle& traceHandle, FTraceDatum& traceDatum);
+    void OnAsyncPerceptionTraceDone();
+    AActor* ConsumeAsyncPerception();
+    void CheckPerceptionParity(bool syncSeesPlayer, bool asyncSeesPlayer);
 
 private:
-    virtual void GoToBestTarget(float deltaTime) override;
-    virtual void ChooseBehavior(float deltaTime) override;
     virtual void ShowNavigationPath() override;
-    virtual void GoToBestCollectible();
+    virtual void GoToBestCollectible(const TArray<const ASDTCollectible*>& candidates);
     virtual bool TargetIsVisible(FVector targetLocation);
-    virtual AActor* GetBestFleeLocation();
-    virtual void GoToBestFleeLocation();
-    virtual void GoToPlayer();
+    virtual AActor* GetBestFleeLocation(const TArray<ASDTFleeLocation*>& fleeLocations, const FVector& playerLoc);
+    virtual void GoToBestFleeLocation(const TArray<ASDTFleeLocation*>& fleeLocations, const FVector& playerLoc);
+    virtual void GoToPlayer(const FVector& moveLocation, bool usePathfinding);
+    virtual void GoToFleeWaypoint(const FVector& waypoint);
+
+    void OnCollectiblePathFound(uint32 queryId, ENavigationQueryResult::Type result, FNavPathSharedPtr path, int32 candidateIndex, uint32 batchId);
+    void ApplyCollectiblePathBatch();
+    void CancelCollectiblePathBatch();
+    void ReleaseCollectibleClaim();
+    FSDTWorldSnapshotPtr GetWorldSnapshot() const;
+
+    void OnCollectibleAvailabilityChanged(ASDTCollectible* collectible, bool available);
+    void OnPowerUpChanged(ASoftDesignTrainingMainCharacter* player, bool poweredUp);
+    void OnCharacterDied(ASoftDesignTrainingCharacter* character);
 
     // Current AI state
     enum PawnObjective {
@@ -82,4 +134,96 @@ private:
     PawnObjective m_currentObjective;
     AActor* m_targetPlayer;
     AActor* m_TargetActor;
+
+    // State read by the compute phase, stored by the gather phase
+    struct FDecisionInput
+    {
+        FSDTWorldSnapshotPtr Snapshot;
+        const USDTCollectibleRegistry* Registry = nullptr;
+        const USDTCollectibleAssignment* Assignment = nullptr;
+        const USDTFleeTable* FleeTable = nullptr;
+        const USDTNavDistanceTable* DistanceTable = nullptr;
+        const USDTPlayerDistanceField* PlayerDistanceField = nullptr;
+        const ASDTCollectible* AssignedCollectible = nullptr;
+        FVector PawnLocation = FVector::ZeroVector;
+        bool HasPawn = false;
+        bool PerceptionUpdated = false;
+        AActor* VisiblePlayer = nullptr;
+        AActor* TargetPlayer = nullptr;
+        PawnObjective Objective = PawnObjective::None;
+        bool ReachedTarget = false;
+        bool PlayerPoweredUp = false;
+        bool CanSearchCollectible = false;
+    };
+
+    // Result of the compute phase, applied on the game thread
+    struct FDecisionCommand
+    {
+        enum EAction
+        {
+            None,
+            EvaluateCollectibles,
+            WaitForCollectible,
+            MoveToPlayer,
+            FleeFromPlayer,
+            FleeAlongField,
+        };
+
+        PawnObjective Objective = PawnObjective::None;
+        AActor* TargetPlayer = nullptr;
+        bool ForceRetarget = false;
+        bool Interrupt = false;
+        EAction Action = None;
+        FVector PlayerLocation = FVector::ZeroVector;
+        FVector MoveLocation = FVector::ZeroVector;
+        bool UsePathfinding = true;
+        TArray<const ASDTCollectible*> Collectibles;
+        TArray<ASDTFleeLocation*> FleeLocations;
+    };
+
+    void UpdateBehavior(const FDecisionInput& input, FDecisionCommand& command) const;
+    void ChooseTarget(const FDecisionInput& input, FDecisionCommand& command) const;
+    void PrefilterCollectibles(const FDecisionInput& input, TArray<const ASDTCollectible*>& inOutCollectibles) const;
+
+    FDecisionInput m_DecisionInput;
+    FDecisionCommand m_DecisionCommand;
+
+    // Identifier of the pawn in the collectible reservation table
+    int32 m_AgentId = INDEX_NONE;
+
+    // Jump curve and apex height of the pawn in the jump table
+    int32 m_JumpProfile = INDEX_NONE;
+
+    // Updated by the game events
+    bool m_PlayerPoweredUp = false;
+    bool m_WaitingForCollectible = false;
+    FDelegateHandle m_CollectibleAvailabilityHandle;
+    FDelegateHandle m_PowerUpHandle;
+    FDelegateHandle m_CharacterDiedHandle;
+
+    // Collectible candidates whose paths are being computed asynchronously
+    struct FCollectiblePathBatch
+    {
+        uint32 Id = 0;
+        int32 PendingCount = 0;
+        TArray<TWeakObjectPtr<const ASDTCollectible>> Candidates;
+        TArray<FNavPathSharedPtr> Paths;
+    };
+    FCollectiblePathBatch m_CollectiblePathBatch;
+
+    // Perception traces run by the physics async trace pass
+    struct FAsyncPerception
+    {
+        uint32 RequestId = 0;
+        int32 PendingTraces = 0;
+        bool ResultReady = false;
+        FHitResult DetectionHit;
+        bool PlayerIsBlocked = true;
+    };
+    FAsyncPerception m_AsyncPerception;
+    FTraceDelegate m_DetectionTraceDelegate;
+    FTraceDelegate m_VisibilityTraceDelegate;
+
+    bool m_PreviousSyncSeesPlayer = false;
+    int32 m_PerceptionParityMismatchCount = 0;
 };
@@ -0,0 +1,121 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "SDTAIScheduler.h"
+#include "SoftDesignTraining.h"
+#include "SDTBaseAIController.h"
+#include "SDTStats.h"
+#include "Async/ParallelFor.h"
+
+namespace
+{
+    TAutoConsoleVariable<int32> CVarParallelDecisions(
+        TEXT("sdt.ParallelDecisions"),
+        1,
+        TEXT("Computes the decisions of the AI controllers on worker threads.\n")
+        TEXT(" 0: game thread\n")
+        TEXT(" 1: worker threads"),
+        ECVF_Default);
+}
+
+void USDTAIScheduler::RegisterController(ASDTBaseAIController* controller)
+{
+    if (!controller || m_Controllers.ContainsByPredicate([controller](const FScheduledController& scheduled) { return scheduled.Controller == controller; }))
+        return;
+
+    // new controllers get a decision on their first frame
+    m_Controllers.Add({ controller, GetWorld()->GetTimeSeconds(), MAX_int32 / 2 });
+}
+
+void USDTAIScheduler::UnregisterController(ASDTBaseAIController* controller)
+{
+    m_Controllers.RemoveAll([controller](const FScheduledController& scheduled) { return scheduled.Controller == controller; });
+}
+
+bool USDTAIScheduler::IsTickable() const
+{
+    const UWorld* world = GetWorld();
+    return !HasAnyFlags(RF_ClassDefaultObject) && world && world->IsGameWorld();
+}
+
+TStatId USDTAIScheduler::GetStatId() const
+{
+    RETURN_QUICK_DECLARE_CYCLE_STAT(USDTAIScheduler, STATGROUP_Tickables);
+}
+
+/*
+ * Updates the controllers with the highest priority first until the frame budget is spent.
+ * With equal base priorities, the controller that waited the longest always comes first, which makes the scheduling round-robin.
+ * The number of controllers fitting in the budget is estimated from the game thread cost of the previous updates,
+ * the compute phase is not counted since it is spread over the worker threads.
+ */
+void USDTAIScheduler::Tick(float deltaTime)
+{
+    if (m_Controllers.Num() == 0)
+        return;
+
+    const float currentTime = GetWorld()->GetTimeSeconds();
+
+    auto getPriority = [this](const FScheduledController& scheduled) {
+        return scheduled.Controller->GetUpdatePriority() + scheduled.WaitedFrames * m_PriorityAgingPerFrame;
+    };
+
+    m_UpdateOrder.Reset(m_Controllers.Num());
+    for (int32 i = 0; i < m_Controllers.Num(); ++i)
+    {
+        m_UpdateOrder.Add(i);
+    }
+    // equal priorities keep the registration order, so the commands are always applied in the same order
+    m_UpdateOrder.StableSort([&](int32 index1, int32 index2) {
+        return getPriority(m_Controllers[index1]) > getPriority(m_Controllers[index2]);
+    });
+
+    const double budget = m_FrameBudgetMs / 1000.0;
+    const int32 maxUpdateCount = m_GameThreadSecondsPerUpdate > 0.0 ? FMath::Clamp(FMath::FloorToInt(budget / m_GameThreadSecondsPerUpdate), 1, m_UpdateOrder.Num()) : m_UpdateOrder.Num();
+
+    m_UpdatedControllers.Reset(maxUpdateCount);
+    m_UpdatedControllers.Append(m_UpdateOrder.GetData(), maxUpdateCount);
+
+    double gameThreadSeconds = 0.0;
+    {
+        SDT_SCOPE_CYCLE_STAT(GatherDecisions);
+        const double startTime = FPlatformTime::Seconds();
+
+        for (int32 index : m_UpdatedControllers)
+        {
+            FScheduledController& scheduled = m_Controllers[index];
+            scheduled.Controller->GatherDecisionInput(currentTime - scheduled.LastUpdateTime);
+        }
+        gameThreadSeconds += FPlatformTime::Seconds() - startTime;
+    }
+
+    {
+        SDT_SCOPE_CYCLE_STAT(ComputeDecisions);
+
+        const bool singleThread = CVarParallelDecisions.GetValueOnGameThread() == 0;
+        ParallelFor(m_UpdatedControllers.Num(), [this](int32 i) {
+            m_Controllers[m_UpdatedControllers[i]].Controller->ComputeDecision();
+        }, singleThread);
+    }
+
+    {
+        SDT_SCOPE_CYCLE_STAT(ApplyDecisions);
+        const double startTime = FPlatformTime::Seconds();
+
+        for (int32 index : m_UpdatedControllers)
+        {
+            FScheduledController& scheduled = m_Controllers[index];
+            scheduled.Controller->ApplyDecision(currentTime - scheduled.LastUpdateTime);
+            scheduled.LastUpdateTime = currentTime;
+            scheduled.WaitedFrames = -1;
+        }
+        gameThreadSeconds += FPlatformTime::Seconds() - startTime;
+    }
+
+    const double secondsPerUpdate = gameThreadSeconds / m_UpdatedControllers.Num();
+    m_GameThreadSecondsPerUpdate = m_GameThreadSecondsPerUpdate > 0.0 ? FMath::Lerp(m_GameThreadSecondsPerUpdate, secondsPerUpdate, 0.25) : secondsPerUpdate;
+
+    for (FScheduledController& scheduled : m_Controllers)
+    {
+        scheduled.WaitedFrames = FMath::Min(scheduled.WaitedFrames + 1, MAX_int32 / 2);
+    }
+}
@@ -0,0 +1,58 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Tickable.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "SDTAIScheduler.generated.h"
+
+class ASDTBaseAIController;
+
+/**
+ * Owns the decision updates of the AI controllers.
+ * Every frame, controllers are updated by priority until the frame budget is spent. The priority of a controller grows with
+ * the number of frames it has been waiting, so all of them are eventually served. Movement is not affected: the path
+ * following components keep ticking every frame.
+ * The updated controllers go through the decision phases together: their inputs are gathered on the game thread, their
+ * decisions are computed in parallel on worker threads, then their commands are applied on the game thread in priority order.
+ */
+UCLASS(config = Game)
+class SOFTDESIGNTRAINING_API USDTAIScheduler : public UWorldSubsystem, public FTickableGameObject
+{
+    GENERATED_BODY()
+
+public:
+    void RegisterController(ASDTBaseAIController* controller);
+    void UnregisterController(ASDTBaseAIController* controller);
+
+    int32 GetControllerCount() const { return m_Controllers.Num(); }
+    ASDTBaseAIController* GetController(int32 index) const { return m_Controllers[index].Controller; }
+
+    virtual void Tick(float deltaTime) override;
+    virtual bool IsTickable() const override;
+    virtual TStatId GetStatId() const override;
+    virtual UWorld* GetTickableGameObjectWorld() const override { return GetWorld(); }
+
+    // Time given to the decision updates every frame, in milliseconds. At least one controller is updated per frame.
+    UPROPERTY(config)
+    float m_FrameBudgetMs = 2.f;
+
+    // Priority gained by a controller for every frame spent waiting for an update
+    UPROPERTY(config)
+    float m_PriorityAgingPerFrame = 1.f;
+
+private:
+    struct FScheduledController
+    {
+        ASDTBaseAIController* Controller;
+        float LastUpdateTime;
+        int32 WaitedFrames;
+    };
+    TArray<FScheduledController> m_Controllers;
+    TArray<int32> m_UpdateOrder;
+    TArray<int32> m_UpdatedControllers;
+
+    // Game thread time of the gather and apply phases per controller, averaged over the previous frames
+    double m_GameThreadSecondsPerUpdate = 0.0;
+};
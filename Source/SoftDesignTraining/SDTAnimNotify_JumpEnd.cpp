@@ -8,4 +8,10 @@
 void USDTAnimNotify_JumpEnd::Notify(USkeletalMeshComponent * MeshComp, UAnimSequenceBase * Animation)
 {
     //Notify that our NPC has landed
+    APawn* pawn = MeshComp ? Cast<APawn>(MeshComp->GetOwner()) : nullptr;
+    if (ASDTAIController* controller = pawn ? Cast<ASDTAIController>(pawn->GetController()) : nullptr)
+    {
+        controller->InAir = false;
+        controller->Landing = false;
+    }
 }
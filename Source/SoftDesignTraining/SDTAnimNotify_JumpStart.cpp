@@ -8,4 +8,10 @@
 void USDTAnimNotify_JumpStart::Notify(USkeletalMeshComponent * MeshComp, UAnimSequenceBase * Animation)
 {
     //Notify that the NPC has launched
+    APawn* pawn = MeshComp ? Cast<APawn>(MeshComp->GetOwner()) : nullptr;
+    if (ASDTAIController* controller = pawn ? Cast<ASDTAIController>(pawn->GetController()) : nullptr)
+    {
+        controller->InAir = true;
+        controller->Landing = false;
+    }
 }
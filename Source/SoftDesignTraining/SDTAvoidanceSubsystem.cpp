@@ -0,0 +1,197 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "SDTAvoidanceSubsystem.h"
+#include "SoftDesignTraining.h"
+#include "SDTPathFollowingComponent.h"
+#include "GameFramework/Pawn.h"
+
+void USDTAvoidanceSubsystem::RegisterAgent(USDTPathFollowingComponent* agent)
+{
+    if (agent)
+        m_Agents.AddUnique(agent);
+}
+
+void USDTAvoidanceSubsystem::UnregisterAgent(USDTPathFollowingComponent* agent)
+{
+    m_Agents.RemoveSingleSwap(agent);
+}
+
+bool USDTAvoidanceSubsystem::IsTickable() const
+{
+    const UWorld* world = GetWorld();
+    return !HasAnyFlags(RF_ClassDefaultObject) && world && world->IsGameWorld();
+}
+
+TStatId USDTAvoidanceSubsystem::GetStatId() const
+{
+    RETURN_QUICK_DECLARE_CYCLE_STAT(USDTAvoidanceSubsystem, STATGROUP_Tickables);
+}
+
+void USDTAvoidanceSubsystem::Tick(float deltaTime)
+{
+    GatherAgents();
+
+    const int32 agentCount = m_PositionX.Num();
+    if (agentCount == 0)
+        return;
+
+    m_Grid.Reset();
+    for (int32 i = 0; i < agentCount; ++i)
+    {
+        m_Grid.FindOrAdd(FIntPoint(FMath::FloorToInt(m_PositionX[i] / m_NeighborRadius), FMath::FloorToInt(m_PositionY[i] / m_NeighborRadius))).Add(i);
+    }
+
+    const float neighborRadiusSquared = FMath::Square(m_NeighborRadius);
+    TArray<int32, TInlineAllocator<32>> neighbors;
+
+    for (int32 i = 0; i < agentCount; ++i)
+    {
+        // neighbors within the radius in the 3x3 cells around the agent
+        neighbors.Reset();
+        const FIntPoint cell(FMath::FloorToInt(m_PositionX[i] / m_NeighborRadius), FMath::FloorToInt(m_PositionY[i] / m_NeighborRadius));
+        for (int32 y = -1; y <= 1 && neighbors.Num() < m_MaxNeighbors; ++y)
+        {
+            for (int32 x = -1; x <= 1 && neighbors.Num() < m_MaxNeighbors; ++x)
+            {
+                const auto* cellAgents = m_Grid.Find(FIntPoint(cell.X + x, cell.Y + y));
+                if (!cellAgents)
+                    continue;
+
+                for (int32 neighbor : *cellAgents)
+                {
+                    if (neighbor != i && FMath::Square(m_PositionX[neighbor] - m_PositionX[i]) + FMath::Square(m_PositionY[neighbor] - m_PositionY[i]) <= neighborRadiusSquared)
+                        neighbors.Add(neighbor);
+
+                    if (neighbors.Num() >= m_MaxNeighbors)
+                        break;
+                }
+            }
+        }
+
+        USDTPathFollowingComponent* agent = m_Agents[i];
+        const FVector preferredVelocity = agent->GetPreferredVelocity();
+        if (neighbors.Num() == 0 || preferredVelocity.IsNearlyZero())
+        {
+            agent->SetAvoidanceVelocity(preferredVelocity);
+            continue;
+        }
+
+        // keep the speed the agent wants, only its direction is changed
+        const FVector2D avoidance = ComputeAvoidance(i, neighbors);
+        const FVector newVelocity = (preferredVelocity + FVector(avoidance, 0.f)).GetClampedToMaxSize2D(preferredVelocity.Size2D());
+        agent->SetAvoidanceVelocity(newVelocity);
+    }
+}
+
+void USDTAvoidanceSubsystem::GatherAgents()
+{
+    m_PositionX.Reset();
+    m_PositionY.Reset();
+    m_VelocityX.Reset();
+    m_VelocityY.Reset();
+    m_Radius.Reset();
+
+    m_Agents.RemoveAllSwap([](const USDTPathFollowingComponent* agent) { return !agent || !agent->GetPawnForAvoidance(); });
+
+    for (const USDTPathFollowingComponent* agent : m_Agents)
+    {
+        const APawn* pawn = agent->GetPawnForAvoidance();
+        const FVector location = pawn->GetActorLocation();
+        const FVector velocity = pawn->GetVelocity();
+
+        m_PositionX.Add(location.X);
+        m_PositionY.Add(location.Y);
+        m_VelocityX.Add(velocity.X);
+        m_VelocityY.Add(velocity.Y);
+        m_Radius.Add(pawn->GetSimpleCollisionRadius());
+    }
+}
+
+/*
+ * Sums the pushes of the neighbors on the agent. For each neighbor, the time to collision tau solves
+ * |w - v * tau| = r with w the offset to the neighbor, v the relative velocity and r the sum of the radii.
+ * The agent is pushed away from where the neighbor will be at tau, with a strength decreasing to zero at the time horizon.
+ */
+FVector2D USDTAvoidanceSubsystem::ComputeAvoidance(int32 agentIndex, const TArray<int32, TInlineAllocator<32>>& neighbors)
+{
+    const int32 paddedCount = Align(neighbors.Num(), 4);
+    m_NeighborOffsetX.SetNumUninitialized(paddedCount, false);
+    m_NeighborOffsetY.SetNumUninitialized(paddedCount, false);
+    m_NeighborVelocityX.SetNumUninitialized(paddedCount, false);
+    m_NeighborVelocityY.SetNumUninitialized(paddedCount, false);
+    m_NeighborRadius.SetNumUninitialized(paddedCount, false);
+
+    for (int32 i = 0; i < paddedCount; ++i)
+    {
+        if (i < neighbors.Num())
+        {
+            const int32 neighbor = neighbors[i];
+            m_NeighborOffsetX[i] = m_PositionX[neighbor] - m_PositionX[agentIndex];
+            m_NeighborOffsetY[i] = m_PositionY[neighbor] - m_PositionY[agentIndex];
+            m_NeighborVelocityX[i] = m_VelocityX[agentIndex] - m_VelocityX[neighbor];
+            m_NeighborVelocityY[i] = m_VelocityY[agentIndex] - m_VelocityY[neighbor];
+            m_NeighborRadius[i] = m_Radius[agentIndex] + m_Radius[neighbor];
+        }
+        else
+        {
+            // far away and static, never colliding
+            m_NeighborOffsetX[i] = BIG_NUMBER;
+            m_NeighborOffsetY[i] = 0.f;
+            m_NeighborVelocityX[i] = 0.f;
+            m_NeighborVelocityY[i] = 0.f;
+            m_NeighborRadius[i] = 0.f;
+        }
+    }
+
+    const VectorRegister zero = VectorZero();
+    const VectorRegister epsilon = VectorSetFloat1(KINDA_SMALL_NUMBER);
+    const VectorRegister one = VectorOne();
+    const VectorRegister horizon = VectorSetFloat1(m_TimeHorizon);
+    const VectorRegister inverseHorizon = VectorSetFloat1(1.f / FMath::Max(m_TimeHorizon, KINDA_SMALL_NUMBER));
+    const VectorRegister strength = VectorSetFloat1(m_AvoidanceStrength);
+
+    VectorRegister pushX = zero;
+    VectorRegister pushY = zero;
+
+    for (int32 i = 0; i < paddedCount; i += 4)
+    {
+        const VectorRegister offsetX = VectorLoadAligned(&m_NeighborOffsetX[i]);
+        const VectorRegister offsetY = VectorLoadAligned(&m_NeighborOffsetY[i]);
+        const VectorRegister velocityX = VectorLoadAligned(&m_NeighborVelocityX[i]);
+        const VectorRegister velocityY = VectorLoadAligned(&m_NeighborVelocityY[i]);
+        const VectorRegister radius = VectorLoadAligned(&m_NeighborRadius[i]);
+
+        // a * tau^2 - 2 * b * tau + c = 0
+        const VectorRegister a = VectorMultiplyAdd(velocityX, velocityX, VectorMultiply(velocityY, velocityY));
+        const VectorRegister b = VectorMultiplyAdd(offsetX, velocityX, VectorMultiply(offsetY, velocityY));
+        const VectorRegister c = VectorSubtract(VectorMultiplyAdd(offsetX, offsetX, VectorMultiply(offsetY, offsetY)), VectorMultiply(radius, radius));
+        const VectorRegister discriminant = VectorSubtract(VectorMultiply(b, b), VectorMultiply(a, c));
+
+        const VectorRegister clampedDiscriminant = VectorMax(discriminant, epsilon);
+        const VectorRegister root = VectorMultiply(clampedDiscriminant, VectorReciprocalSqrtAccurate(clampedDiscriminant));
+        const VectorRegister approachingTau = VectorMultiply(VectorSubtract(b, root), VectorReciprocalAccurate(VectorMax(a, epsilon)));
+
+        // already overlapping neighbors push right away
+        const VectorRegister overlapping = VectorCompareGT(zero, c);
+        const VectorRegister approaching = VectorBitwiseAnd(VectorCompareGT(discriminant, zero), VectorBitwiseAnd(VectorCompareGT(approachingTau, zero), VectorCompareGT(horizon, approachingTau)));
+        const VectorRegister colliding = VectorBitwiseOr(overlapping, approaching);
+        const VectorRegister tau = VectorSelect(overlapping, zero, approachingTau);
+
+        // offset to the neighbor at the time of the collision
+        const VectorRegister collisionX = VectorSubtract(offsetX, VectorMultiply(velocityX, tau));
+        const VectorRegister collisionY = VectorSubtract(offsetY, VectorMultiply(velocityY, tau));
+        const VectorRegister inverseLength = VectorReciprocalSqrtAccurate(VectorMax(VectorMultiplyAdd(collisionX, collisionX, VectorMultiply(collisionY, collisionY)), epsilon));
+
+        const VectorRegister falloff = VectorSubtract(one, VectorMultiply(tau, inverseHorizon));
+        const VectorRegister weight = VectorSelect(colliding, VectorMultiply(VectorMultiply(strength, falloff), inverseLength), zero);
+
+        pushX = VectorSubtract(pushX, VectorMultiply(collisionX, weight));
+        pushY = VectorSubtract(pushY, VectorMultiply(collisionY, weight));
+    }
+
+    MS_ALIGN(16) float sumX[4] GCC_ALIGN(16);
+    MS_ALIGN(16) float sumY[4] GCC_ALIGN(16);
+    VectorStoreAligned(pushX, sumX);
+    VectorStoreAligned(pushY, sumY);
+    return FVector2D(sumX[0] + sumX[1] + sumX[2] + sumX[3], sumY[0] + sumY[1] + sumY[2] + sumY[3]);
+}
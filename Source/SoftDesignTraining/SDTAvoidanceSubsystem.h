@@ -0,0 +1,68 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Tickable.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "SDTAvoidanceSubsystem.generated.h"
+
+class USDTPathFollowingComponent;
+
+/**
+ * Local avoidance of all the AI pawns, computed in one batch per frame.
+ * Path following components publish the velocity they want, then each pawn is pushed away from the neighbors it would
+ * collide with within the time horizon, more strongly for imminent collisions (time to collision avoidance).
+ * Neighbors come from a grid and are processed 4 at a time. The velocities are used by the path following components on
+ * the next frame.
+ */
+UCLASS(config = Game)
+class SOFTDESIGNTRAINING_API USDTAvoidanceSubsystem : public UWorldSubsystem, public FTickableGameObject
+{
+    GENERATED_BODY()
+
+public:
+    void RegisterAgent(USDTPathFollowingComponent* agent);
+    void UnregisterAgent(USDTPathFollowingComponent* agent);
+
+    virtual void Tick(float deltaTime) override;
+    virtual bool IsTickable() const override;
+    virtual TStatId GetStatId() const override;
+    virtual UWorld* GetTickableGameObjectWorld() const override { return GetWorld(); }
+
+    // Distance within which pawns avoid each other, also the size of the grid cells
+    UPROPERTY(config)
+    float m_NeighborRadius = 300.f;
+
+    UPROPERTY(config)
+    int32 m_MaxNeighbors = 16;
+
+    // Collisions further in the future are ignored, in seconds
+    UPROPERTY(config)
+    float m_TimeHorizon = 1.5f;
+
+    // Velocity change for an immediate collision, in world units per second
+    UPROPERTY(config)
+    float m_AvoidanceStrength = 400.f;
+
+private:
+    typedef TArray<float, TAlignedHeapAllocator<16>> FAlignedFloats;
+
+    void GatherAgents();
+    FVector2D ComputeAvoidance(int32 agentIndex, const TArray<int32, TInlineAllocator<32>>& neighbors);
+
+    UPROPERTY()
+    TArray<USDTPathFollowingComponent*> m_Agents;
+
+    // Agent state, gathered every frame
+    TArray<float> m_PositionX, m_PositionY;
+    TArray<float> m_VelocityX, m_VelocityY;
+    TArray<float> m_Radius;
+
+    // Neighbor data relative to the current agent, padded to a multiple of 4 neighbors
+    FAlignedFloats m_NeighborOffsetX, m_NeighborOffsetY;
+    FAlignedFloats m_NeighborVelocityX, m_NeighborVelocityY;
+    FAlignedFloats m_NeighborRadius;
+
+    TMap<FIntPoint, TArray<int32, TInlineAllocator<8>>> m_Grid;
+};
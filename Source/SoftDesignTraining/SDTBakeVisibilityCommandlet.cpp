@@ -0,0 +1,209 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "SDTBakeVisibilityCommandlet.h"
+#include "SoftDesignTraining.h"
+#include "SDTNavGrid.h"
+#include "SDTUtils.h"
+#include "SDTVisibilityData.h"
+#include "SDTVisibilitySubsystem.h"
+#include "NavigationSystem.h"
+#include "NavigationData.h"
+#include "EngineUtils.h"
+#include "Components/PrimitiveComponent.h"
+#include "Misc/PackageName.h"
+#include "Misc/Compression.h"
+#include "UObject/Package.h"
+
+namespace
+{
+    void CompressBits(const TBitArray<>& bits, int32 bitsetSize, TArray<uint8>& outCompressed)
+    {
+        TArray<uint8> uncompressed;
+        uncompressed.SetNumZeroed(bitsetSize);
+        for (TConstSetBitIterator<> it(bits); it; ++it)
+        {
+            uncompressed[it.GetIndex() / 8] |= 1 << (it.GetIndex() % 8);
+        }
+
+        int32 compressedSize = FCompression::CompressMemoryBound(NAME_Zlib, bitsetSize);
+        outCompressed.SetNumUninitialized(compressedSize);
+        FCompression::CompressMemory(NAME_Zlib, outCompressed.GetData(), compressedSize, uncompressed.GetData(), bitsetSize);
+        outCompressed.SetNum(compressedSize);
+    }
+}
+
+USDTBakeVisibilityCommandlet::USDTBakeVisibilityCommandlet()
+{
+    IsClient = false;
+    IsEditor = true;
+    IsServer = false;
+    LogToConsole = true;
+}
+
+int32 USDTBakeVisibilityCommandlet::Main(const FString& Params)
+{
+#if WITH_EDITOR
+    FString mapName;
+    if (!FParse::Value(*Params, TEXT("map="), mapName))
+    {
+        UE_LOG(LogSoftDesignTraining, Error, TEXT("SDTBakeVisibility: missing -map=<long package name>"));
+        return 1;
+    }
+
+    float cellSize = 200.f;
+    float eyeHeight = 90.f;
+    FParse::Value(*Params, TEXT("cellsize="), cellSize);
+    FParse::Value(*Params, TEXT("eyeheight="), eyeHeight);
+
+    UPackage* mapPackage = LoadPackage(nullptr, *mapName, LOAD_None);
+    UWorld* world = mapPackage ? UWorld::FindWorldInPackage(mapPackage) : nullptr;
+    if (!world)
+    {
+        UE_LOG(LogSoftDesignTraining, Error, TEXT("SDTBakeVisibility: could not load map %s"), *mapName);
+        return 1;
+    }
+
+    // initialize the world with collision and navigation only
+    world->WorldType = EWorldType::Editor;
+    world->AddToRoot();
+    if (!world->bIsWorldInitialized)
+    {
+        UWorld::InitializationValues initValues;
+        initValues.RequiresHitProxies(false).ShouldSimulatePhysics(false).EnableTraceCollision(true).CreateNavigation(true).CreateAISystem(false).AllowAudioPlayback(false);
+        world->InitWorld(initValues);
+    }
+    world->UpdateWorldComponents(true, false);
+
+    if (UNavigationSystemV1* navSystem = FNavigationSystem::GetCurrent<UNavigationSystemV1>(world))
+        navSystem->Build();
+
+    const FString assetName = USDTVisibilitySubsystem::GetVisibilityDataName(*world);
+    const FString packageName = USDTVisibilitySubsystem::GetVisibilityDataPackageName(*world);
+    UPackage* dataPackage = CreatePackage(nullptr, *packageName);
+    USDTVisibilityData* data = NewObject<USDTVisibilityData>(dataPackage, *assetName, RF_Public | RF_Standalone);
+
+    if (!Bake(world, cellSize, eyeHeight, data))
+    {
+        world->DestroyWorld(false);
+        world->RemoveFromRoot();
+        return 1;
+    }
+
+    dataPackage->MarkPackageDirty();
+    const FString fileName = FPackageName::LongPackageNameToFilename(packageName, FPackageName::GetAssetPackageExtension());
+    const bool saved = UPackage::SavePackage(dataPackage, data, RF_Public | RF_Standalone, *fileName);
+
+    world->DestroyWorld(false);
+    world->RemoveFromRoot();
+
+    if (!saved)
+    {
+        UE_LOG(LogSoftDesignTraining, Error, TEXT("SDTBakeVisibility: could not save %s"), *fileName);
+        return 1;
+    }
+
+    UE_LOG(LogSoftDesignTraining, Display, TEXT("SDTBakeVisibility: saved %s (%d walkable cells, %d + %d compressed bytes)"),
+        *fileName, data->m_WalkableCount, data->m_CompressedVisibleBits.Num(), data->m_CompressedAmbiguousBits.Num());
+    return 0;
+#else
+    UE_LOG(LogSoftDesignTraining, Error, TEXT("SDTBakeVisibility can only run in the editor"));
+    return 1;
+#endif
+}
+
+/*
+ * Traces between every pair of walkable cells, with the same channel and params as the line of sight traces it replaces.
+ * Only the static geometry is baked: the components that can move are ignored, the runtime raycast handles them.
+ * The cell centers are traced first, then the corners of the cells: when the traces disagree, the pair is ambiguous.
+ */
+bool USDTBakeVisibilityCommandlet::Bake(UWorld* world, float cellSize, float eyeHeight, USDTVisibilityData* outData)
+{
+    UNavigationSystemV1* navSystem = FNavigationSystem::GetCurrent<UNavigationSystemV1>(world);
+    const ANavigationData* navData = navSystem ? navSystem->GetDefaultNavDataInstance(FNavigationSystem::DontCreate) : nullptr;
+    if (!navData)
+    {
+        UE_LOG(LogSoftDesignTraining, Error, TEXT("SDTBakeVisibility: no navmesh, nothing to bake"));
+        return false;
+    }
+
+    FSDTNavGrid grid;
+    grid.Build(*navSystem, *navData, navData->GetBounds(), cellSize);
+
+    outData->m_Origin = grid.GetOrigin();
+    outData->m_CellSize = cellSize;
+    outData->m_GridSize = grid.GetGridSize();
+    outData->m_WalkableIndices.Init(INDEX_NONE, grid.GetCellCount());
+
+    TArray<FVector> eyeLocations;
+    for (int32 cellIndex = 0; cellIndex < grid.GetCellCount(); ++cellIndex)
+    {
+        if (grid.IsWalkable(cellIndex))
+        {
+            outData->m_WalkableIndices[cellIndex] = eyeLocations.Num();
+            eyeLocations.Add(grid.GetCellLocation(cellIndex) + FVector(0.f, 0.f, eyeHeight));
+        }
+    }
+
+    const int32 walkableCount = eyeLocations.Num();
+    if (!USDTVisibilityData::IsWalkableCountSupported(walkableCount))
+    {
+        UE_LOG(LogSoftDesignTraining, Error, TEXT("SDTBakeVisibility: %d walkable cells is too many, use a larger -cellsize"), walkableCount);
+        return false;
+    }
+
+    const int32 pairCount = int32(USDTVisibilityData::GetPairCount(walkableCount));
+    outData->m_WalkableCount = walkableCount;
+    outData->m_BitsetSize = FMath::DivideAndRoundUp(pairCount, 8);
+
+    TBitArray<> visibleBits(false, pairCount);
+    TBitArray<> ambiguousBits(false, pairCount);
+
+    // pawns, spawners and any other movable actor placed in the map must not become permanent walls
+    FCollisionQueryParams traceParams = SDTUtils::GetLineOfSightParams();
+    for (TActorIterator<AActor> it(world); it; ++it)
+    {
+        TInlineComponentArray<UPrimitiveComponent*> primitives(*it);
+        for (UPrimitiveComponent* primitive : primitives)
+        {
+            if (primitive->Mobility != EComponentMobility::Static)
+                traceParams.AddIgnoredComponent(primitive);
+        }
+    }
+    const float cornerOffset = cellSize * 0.35f;
+    const FVector cornerOffsets[] = {
+        FVector(cornerOffset, cornerOffset, 0.f),
+        FVector(-cornerOffset, cornerOffset, 0.f),
+        FVector(cornerOffset, -cornerOffset, 0.f),
+        FVector(-cornerOffset, -cornerOffset, 0.f),
+    };
+
+    for (int32 i = 0; i < walkableCount; ++i)
+    {
+        for (int32 j = i + 1; j < walkableCount; ++j)
+        {
+            const bool centersVisible = !world->LineTraceTestByChannel(eyeLocations[i], eyeLocations[j], COLLISION_LINE_OF_SIGHT, traceParams);
+
+            bool ambiguous = false;
+            for (const FVector& offset : cornerOffsets)
+            {
+                const bool cornersVisible = !world->LineTraceTestByChannel(eyeLocations[i] + offset, eyeLocations[j] + offset, COLLISION_LINE_OF_SIGHT, traceParams);
+                if (cornersVisible != centersVisible)
+                {
+                    ambiguous = true;
+                    break;
+                }
+            }
+
+            const int32 pairIndex = USDTVisibilityData::GetPairIndex(i, j, walkableCount);
+            visibleBits[pairIndex] = centersVisible;
+            ambiguousBits[pairIndex] = ambiguous;
+        }
+
+        if (i % 100 == 0)
+            UE_LOG(LogSoftDesignTraining, Display, TEXT("SDTBakeVisibility: %d / %d cells"), i, walkableCount);
+    }
+
+    CompressBits(visibleBits, outData->m_BitsetSize, outData->m_CompressedVisibleBits);
+    CompressBits(ambiguousBits, outData->m_BitsetSize, outData->m_CompressedAmbiguousBits);
+    return true;
+}
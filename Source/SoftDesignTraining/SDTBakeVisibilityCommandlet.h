@@ -0,0 +1,28 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "SDTBakeVisibilityCommandlet.generated.h"
+
+class USDTVisibilityData;
+
+/**
+ * Bakes the static visibility of a level into a USDTVisibilityData asset.
+ * Usage: UE4Editor-Cmd SoftDesignTraining.uproject -run=SDTBakeVisibility -map=/Game/TopDown/Maps/TopDownExampleMap [-cellsize=200] [-eyeheight=90]
+ * The asset is saved next to the other visibility data, see USDTVisibilitySubsystem.
+ */
+UCLASS()
+class SOFTDESIGNTRAINING_API USDTBakeVisibilityCommandlet : public UCommandlet
+{
+    GENERATED_BODY()
+
+public:
+    USDTBakeVisibilityCommandlet();
+
+    virtual int32 Main(const FString& Params) override;
+
+private:
+    bool Bake(UWorld* world, float cellSize, float eyeHeight, USDTVisibilityData* outData);
+};
@@ -2,30 +2,43 @@
 
 #include "SDTBaseAIController.h"
 #include "SoftDesignTraining.h"
+#include "SDTAIScheduler.h"
 
 
 ASDTBaseAIController::ASDTBaseAIController(const FObjectInitializer& ObjectInitializer)
     :Super(ObjectInitializer)
 {
+    // decisions are updated by the AI scheduler, the tick updates the control rotation and draws debug information
     PrimaryActorTick.bCanEverTick = true;
     PrimaryActorTick.bStartWithTickEnabled = true;
     m_ReachedTarget = true;
 }
 
+void ASDTBaseAIController::BeginPlay()
+{
+    Super::BeginPlay();
+
+    if (USDTAIScheduler* scheduler = GetWorld()->GetSubsystem<USDTAIScheduler>())
+        scheduler->RegisterController(this);
+}
+
+void ASDTBaseAIController::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+    if (USDTAIScheduler* scheduler = GetWorld()->GetSubsystem<USDTAIScheduler>())
+        scheduler->UnregisterController(this);
+
+    Super::EndPlay(EndPlayReason);
+}
+
 void ASDTBaseAIController::Tick(float deltaTime)
 {
     Super::Tick(deltaTime);
 
-    ChooseBehavior(deltaTime);
-
-    if (m_ReachedTarget)
-    {
-        GoToBestTarget(deltaTime);
-    }
-    else
+#if !(UE_BUILD_SHIPPING || UE_BUILD_TEST)
+    // decisions are updated by the AI scheduler, only the debug display runs every frame
+    if (!m_ReachedTarget)
     {
         ShowNavigationPath();
     }
+#endif
 }
-
-
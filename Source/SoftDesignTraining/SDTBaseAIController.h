@@ -18,14 +18,24 @@ public:
 
     ASDTBaseAIController(const FObjectInitializer& ObjectInitializer = FObjectInitializer::Get());
     virtual void Tick(float deltaTime) override;
+
+    virtual float GetUpdatePriority() const { return 0.f; }
+
+    // Decision phases, run by the AI scheduler for all the updated controllers at once, deltaTime is the time elapsed since the previous decision update.
+    // Gather and apply run on the game thread, compute can run on a worker thread: it must only read what gather stored
+    // and write the command applied later, while the game thread waits.
+    virtual void GatherDecisionInput(float deltaTime) {}
+    virtual void ComputeDecision() {}
+    virtual void ApplyDecision(float deltaTime) {}
 	
 protected:
+    virtual void BeginPlay() override;
+    virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
     virtual void RotationUpdate(float deltaTime) {};
     virtual void ImpulseToDirection(float deltaTime) {};
 
     bool m_ReachedTarget;
 private:
-    virtual void GoToBestTarget(float deltaTime) {};
-    virtual void ChooseBehavior(float deltaTime) {};
     virtual void ShowNavigationPath() {};
 };
@@ -0,0 +1,26 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "SDTBenchmark.h"
+#include "SoftDesignTraining.h"
+
+bool FSDTBenchmarkTimers::s_Enabled = false;
+double FSDTBenchmarkTimers::s_Seconds[(int32)ESDTBenchmarkSection::Count] = {};
+
+double FSDTBenchmarkTimers::Consume(ESDTBenchmarkSection section)
+{
+    const double milliseconds = s_Seconds[(int32)section] * 1000.0;
+    s_Seconds[(int32)section] = 0.0;
+    return milliseconds;
+}
+
+const TCHAR* FSDTBenchmarkTimers::GetSectionName(ESDTBenchmarkSection section)
+{
+    switch (section)
+    {
+    case ESDTBenchmarkSection::UpdatePlayerInteraction: return TEXT("UpdatePlayerInteraction");
+    case ESDTBenchmarkSection::GoToBestCollectible:     return TEXT("GoToBestCollectible");
+    case ESDTBenchmarkSection::GetBestFleeLocation:     return TEXT("GetBestFleeLocation");
+    case ESDTBenchmarkSection::FollowPathSegment:       return TEXT("FollowPathSegment");
+    default:                                            return TEXT("Unknown");
+    }
+}
@@ -0,0 +1,60 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * AI functions timed by the benchmark director
+ */
+enum class ESDTBenchmarkSection : uint8
+{
+    UpdatePlayerInteraction,
+    GoToBestCollectible,
+    GetBestFleeLocation,
+    FollowPathSegment,
+    Count
+};
+
+/**
+ * Time spent in each section since the last consume. Only used on the game thread, and only while a benchmark runs.
+ */
+class SOFTDESIGNTRAINING_API FSDTBenchmarkTimers
+{
+public:
+    static bool IsEnabled() { return s_Enabled; }
+    static void SetEnabled(bool enabled) { s_Enabled = enabled; }
+
+    static void Add(ESDTBenchmarkSection section, double seconds) { s_Seconds[(int32)section] += seconds; }
+
+    // Returns the time spent in the section, in milliseconds, and resets it
+    static double Consume(ESDTBenchmarkSection section);
+
+    static const TCHAR* GetSectionName(ESDTBenchmarkSection section);
+
+private:
+    static bool s_Enabled;
+    static double s_Seconds[(int32)ESDTBenchmarkSection::Count];
+};
+
+class FSDTScopedBenchmarkTimer
+{
+public:
+    explicit FSDTScopedBenchmarkTimer(ESDTBenchmarkSection section)
+        : m_Section(section)
+        , m_StartTime(FSDTBenchmarkTimers::IsEnabled() ? FPlatformTime::Seconds() : 0.0)
+    {
+    }
+
+    ~FSDTScopedBenchmarkTimer()
+    {
+        if (m_StartTime > 0.0)
+            FSDTBenchmarkTimers::Add(m_Section, FPlatformTime::Seconds() - m_StartTime);
+    }
+
+private:
+    ESDTBenchmarkSection m_Section;
+    double m_StartTime;
+};
+
+#define SDT_BENCHMARK_SCOPE(Section) FSDTScopedBenchmarkTimer ANONYMOUS_VARIABLE(BenchmarkTimer_)(ESDTBenchmarkSection::Section)
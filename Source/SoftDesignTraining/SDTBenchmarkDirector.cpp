@@ -0,0 +1,252 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "SDTBenchmarkDirector.h"
+#include "SoftDesignTraining.h"
+#include "NavigationSystem.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+void USDTBenchmarkDirector::Initialize(FSubsystemCollectionBase& collection)
+{
+    Super::Initialize(collection);
+
+    const TCHAR* commandLine = FCommandLine::Get();
+    const UWorld* world = GetWorld();
+    if (!FParse::Param(commandLine, TEXT("sdtbenchmark")) || !world || !world->IsGameWorld())
+        return;
+
+    FString agentCounts = TEXT("1,10,100,1000");
+    FParse::Value(commandLine, TEXT("agents="), agentCounts);
+    TArray<FString> agentCountStrings;
+    agentCounts.ParseIntoArray(agentCountStrings, TEXT(","));
+    for (const FString& agentCount : agentCountStrings)
+    {
+        m_AgentCounts.Add(FMath::Max(0, FCString::Atoi(*agentCount)));
+    }
+
+    FParse::Value(commandLine, TEXT("frames="), m_MeasuredFrames);
+    FParse::Value(commandLine, TEXT("warmupframes="), m_WarmupFrames);
+    FParse::Value(commandLine, TEXT("seed="), m_Seed);
+    FParse::Value(commandLine, TEXT("sdtbaseline="), m_BaselinePath);
+    FParse::Value(commandLine, TEXT("sdtthreshold="), m_Threshold);
+
+    if (m_AgentCounts.Num() == 0 || m_MeasuredFrames <= 0)
+    {
+        UE_LOG(LogSoftDesignTraining, Error, TEXT("Benchmark: nothing to run."));
+        return;
+    }
+
+    m_FramesCsv = TEXT("Agents,Frame,GameThreadMs");
+    for (int32 section = 0; section < (int32)ESDTBenchmarkSection::Count; ++section)
+    {
+        m_FramesCsv += FString::Printf(TEXT(",%sMs"), FSDTBenchmarkTimers::GetSectionName((ESDTBenchmarkSection)section));
+    }
+    m_FramesCsv += LINE_TERMINATOR;
+
+    m_State = EState::Spawning;
+}
+
+bool USDTBenchmarkDirector::IsTickable() const
+{
+    return m_State != EState::Inactive && m_State != EState::Done && !HasAnyFlags(RF_ClassDefaultObject);
+}
+
+TStatId USDTBenchmarkDirector::GetStatId() const
+{
+    RETURN_QUICK_DECLARE_CYCLE_STAT(USDTBenchmarkDirector, STATGROUP_Tickables);
+}
+
+void USDTBenchmarkDirector::Tick(float deltaTime)
+{
+    switch (m_State)
+    {
+    case EState::Spawning:
+    {
+        // same seed for every run, so the pawns and their decisions start the same way
+        FMath::RandInit(m_Seed);
+        FMath::SRandInit(m_Seed);
+        SpawnAgents(m_AgentCounts[m_RunIndex]);
+
+        FSDTBenchmarkTimers::SetEnabled(true);
+        m_FrameIndex = 0;
+        m_State = EState::WarmingUp;
+        break;
+    }
+    case EState::WarmingUp:
+    {
+        for (int32 section = 0; section < (int32)ESDTBenchmarkSection::Count; ++section)
+        {
+            FSDTBenchmarkTimers::Consume((ESDTBenchmarkSection)section);
+        }
+
+        if (++m_FrameIndex >= m_WarmupFrames)
+        {
+            m_FrameIndex = 0;
+            m_Samples.Reset(m_MeasuredFrames);
+            m_State = EState::Measuring;
+        }
+        break;
+    }
+    case EState::Measuring:
+    {
+        // the game thread time is the one of the previous frame, the sections were accumulated since the previous tick
+        FFrameSample& sample = m_Samples.AddDefaulted_GetRef();
+        sample.GameThreadMs = FPlatformTime::ToMilliseconds(GGameThreadTime);
+
+        m_FramesCsv += FString::Printf(TEXT("%d,%d,%.4f"), m_AgentCounts[m_RunIndex], m_FrameIndex, sample.GameThreadMs);
+        for (int32 section = 0; section < (int32)ESDTBenchmarkSection::Count; ++section)
+        {
+            sample.SectionMs[section] = FSDTBenchmarkTimers::Consume((ESDTBenchmarkSection)section);
+            m_FramesCsv += FString::Printf(TEXT(",%.4f"), sample.SectionMs[section]);
+        }
+        m_FramesCsv += LINE_TERMINATOR;
+
+        if (++m_FrameIndex >= m_MeasuredFrames)
+            FinishRun();
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+void USDTBenchmarkDirector::SpawnAgents(int32 agentCount)
+{
+    UClass* pawnClass = m_AIPawnClass.TryLoadClass<APawn>();
+    UNavigationSystemV1* navSystem = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld());
+    if (!pawnClass || !navSystem)
+    {
+        UE_LOG(LogSoftDesignTraining, Error, TEXT("Benchmark: no AI pawn class or navigation system, no pawn spawned."));
+        return;
+    }
+
+    FActorSpawnParameters spawnParameters;
+    spawnParameters.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
+
+    for (int32 i = 0; i < agentCount; ++i)
+    {
+        FNavLocation spawnLocation;
+        if (!navSystem->GetRandomPoint(spawnLocation))
+            break;
+
+        const FRotator rotation(0.f, FMath::FRandRange(0.f, 360.f), 0.f);
+        APawn* pawn = GetWorld()->SpawnActor<APawn>(pawnClass, spawnLocation.Location + FVector(0.f, 0.f, 100.f), rotation, spawnParameters);
+        if (!pawn)
+            continue;
+
+        if (!pawn->GetController())
+            pawn->SpawnDefaultController();
+        m_Agents.Add(pawn);
+    }
+
+    UE_LOG(LogSoftDesignTraining, Display, TEXT("Benchmark: %d/%d pawns spawned."), m_Agents.Num(), agentCount);
+}
+
+void USDTBenchmarkDirector::DestroyAgents()
+{
+    for (const TWeakObjectPtr<APawn>& agent : m_Agents)
+    {
+        if (APawn* pawn = agent.Get())
+        {
+            if (AController* controller = pawn->GetController())
+                controller->Destroy();
+            pawn->Destroy();
+        }
+    }
+    m_Agents.Reset();
+}
+
+void USDTBenchmarkDirector::FinishRun()
+{
+    FRunSummary& summary = m_Summaries.AddZeroed_GetRef();
+    summary.AgentCount = m_AgentCounts[m_RunIndex];
+
+    TArray<float> gameThreadTimes;
+    for (const FFrameSample& sample : m_Samples)
+    {
+        gameThreadTimes.Add(sample.GameThreadMs);
+        summary.MeanGameThreadMs += sample.GameThreadMs / m_Samples.Num();
+        for (int32 section = 0; section < (int32)ESDTBenchmarkSection::Count; ++section)
+        {
+            summary.MeanSectionMs[section] += sample.SectionMs[section] / m_Samples.Num();
+        }
+    }
+    gameThreadTimes.Sort();
+    summary.P95GameThreadMs = gameThreadTimes[FMath::Min(gameThreadTimes.Num() - 1, FMath::FloorToInt(gameThreadTimes.Num() * 0.95f))];
+
+    UE_LOG(LogSoftDesignTraining, Display, TEXT("Benchmark: %d agents, game thread %.3f ms (p95 %.3f ms)."), summary.AgentCount, summary.MeanGameThreadMs, summary.P95GameThreadMs);
+
+    FSDTBenchmarkTimers::SetEnabled(false);
+    DestroyAgents();
+
+    m_State = ++m_RunIndex < m_AgentCounts.Num() ? EState::Spawning : EState::Done;
+    if (m_State == EState::Done)
+        Finish();
+}
+
+void USDTBenchmarkDirector::Finish()
+{
+    FString summaryCsv = TEXT("Agents,MeanGameThreadMs,P95GameThreadMs");
+    for (int32 section = 0; section < (int32)ESDTBenchmarkSection::Count; ++section)
+    {
+        summaryCsv += FString::Printf(TEXT(",%sMs"), FSDTBenchmarkTimers::GetSectionName((ESDTBenchmarkSection)section));
+    }
+    summaryCsv += LINE_TERMINATOR;
+
+    for (const FRunSummary& summary : m_Summaries)
+    {
+        summaryCsv += FString::Printf(TEXT("%d,%.4f,%.4f"), summary.AgentCount, summary.MeanGameThreadMs, summary.P95GameThreadMs);
+        for (int32 section = 0; section < (int32)ESDTBenchmarkSection::Count; ++section)
+        {
+            summaryCsv += FString::Printf(TEXT(",%.4f"), summary.MeanSectionMs[section]);
+        }
+        summaryCsv += LINE_TERMINATOR;
+    }
+
+    const FString directory = FPaths::ProjectSavedDir() / TEXT("Benchmark");
+    const FString timestamp = FDateTime::Now().ToString();
+    const FString summaryPath = directory / FString::Printf(TEXT("SDTBenchmark_%s_Summary.csv"), *timestamp);
+    FFileHelper::SaveStringToFile(m_FramesCsv, *(directory / FString::Printf(TEXT("SDTBenchmark_%s_Frames.csv"), *timestamp)));
+    FFileHelper::SaveStringToFile(summaryCsv, *summaryPath);
+    UE_LOG(LogSoftDesignTraining, Display, TEXT("Benchmark: results written to %s."), *summaryPath);
+
+    const bool passed = CheckBaseline();
+    FPlatformMisc::RequestExitWithStatus(false, passed ? 0 : 1);
+}
+
+/*
+ * Compares the mean game thread times with the ones of the baseline summary, agent count by agent count
+ */
+bool USDTBenchmarkDirector::CheckBaseline() const
+{
+    if (m_BaselinePath.IsEmpty())
+        return true;
+
+    TArray<FString> lines;
+    if (!FFileHelper::LoadFileToStringArray(lines, *m_BaselinePath))
+    {
+        UE_LOG(LogSoftDesignTraining, Error, TEXT("Benchmark: cannot read the baseline %s."), *m_BaselinePath);
+        return false;
+    }
+
+    bool passed = true;
+    for (int32 lineIndex = 1; lineIndex < lines.Num(); ++lineIndex)
+    {
+        TArray<FString> values;
+        if (lines[lineIndex].ParseIntoArray(values, TEXT(",")) < 2)
+            continue;
+
+        const int32 agentCount = FCString::Atoi(*values[0]);
+        const float baselineMs = FCString::Atof(*values[1]);
+        const FRunSummary* summary = m_Summaries.FindByPredicate([agentCount](const FRunSummary& run) { return run.AgentCount == agentCount; });
+        if (!summary)
+            continue;
+
+        if (summary->MeanGameThreadMs > baselineMs * (1.f + m_Threshold))
+        {
+            UE_LOG(LogSoftDesignTraining, Error, TEXT("Benchmark: %d agents regressed from %.3f ms to %.3f ms."), agentCount, baselineMs, summary->MeanGameThreadMs);
+            passed = false;
+        }
+    }
+    return passed;
+}
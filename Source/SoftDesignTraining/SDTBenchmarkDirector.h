@@ -0,0 +1,82 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Tickable.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "SDTBenchmark.h"
+#include "SDTBenchmarkDirector.generated.h"
+
+/**
+ * Headless AI benchmark, enabled by the -sdtbenchmark command line switch:
+ *   UE4Editor SoftDesignTraining.uproject TopDownExampleMap -game -nullrhi -benchmark -fps=30 -unattended -sdtbenchmark
+ *     [-agents=1,10,100,1000] [-frames=600] [-warmupframes=60] [-seed=1234] [-sdtbaseline=<summary csv>] [-sdtthreshold=0.1]
+ * For each agent count, AI pawns are spawned on random navmesh points (fixed seed), then the game thread time and the time
+ * spent in the timed AI functions are recorded every frame. -benchmark -fps gives a fixed timestep. Results are written to
+ * Saved/Benchmark: one CSV with every frame and one summary CSV. With a baseline summary, the game exits with status 1 when
+ * the mean game thread time of an agent count regresses by more than the threshold.
+ */
+UCLASS(config = Game)
+class SOFTDESIGNTRAINING_API USDTBenchmarkDirector : public UWorldSubsystem, public FTickableGameObject
+{
+    GENERATED_BODY()
+
+public:
+    virtual void Initialize(FSubsystemCollectionBase& collection) override;
+
+    virtual void Tick(float deltaTime) override;
+    virtual bool IsTickable() const override;
+    virtual TStatId GetStatId() const override;
+    virtual UWorld* GetTickableGameObjectWorld() const override { return GetWorld(); }
+
+    // Pawn spawned by the benchmark, its AI controller is spawned with it
+    UPROPERTY(config)
+    FSoftClassPath m_AIPawnClass;
+
+private:
+    enum class EState : uint8
+    {
+        Inactive,
+        Spawning,
+        WarmingUp,
+        Measuring,
+        Done
+    };
+
+    struct FFrameSample
+    {
+        float GameThreadMs;
+        float SectionMs[(int32)ESDTBenchmarkSection::Count];
+    };
+
+    struct FRunSummary
+    {
+        int32 AgentCount;
+        float MeanGameThreadMs;
+        float P95GameThreadMs;
+        float MeanSectionMs[(int32)ESDTBenchmarkSection::Count];
+    };
+
+    void SpawnAgents(int32 agentCount);
+    void DestroyAgents();
+    void FinishRun();
+    void Finish();
+    bool CheckBaseline() const;
+
+    EState m_State = EState::Inactive;
+
+    TArray<int32> m_AgentCounts;
+    int32 m_RunIndex = 0;
+    int32 m_MeasuredFrames = 600;
+    int32 m_WarmupFrames = 60;
+    int32 m_Seed = 1234;
+    int32 m_FrameIndex = 0;
+    FString m_BaselinePath;
+    float m_Threshold = 0.1f;
+
+    TArray<TWeakObjectPtr<APawn>> m_Agents;
+    TArray<FFrameSample> m_Samples;
+    TArray<FRunSummary> m_Summaries;
+    FString m_FramesCsv;
+};
@@ -2,18 +2,46 @@
 
 #include "SDTCollectible.h"
 #include "SoftDesignTraining.h"
+#include "SDTCollectibleRegistry.h"
+#include "SDTGameEvents.h"
+#include "SDTNavDistanceTable.h"
 
 ASDTCollectible::ASDTCollectible()
 {
 
 }
 
+void ASDTCollectible::BeginPlay()
+{
+    Super::BeginPlay();
+
+    if (USDTCollectibleRegistry* registry = GetWorld()->GetSubsystem<USDTCollectibleRegistry>())
+        registry->RegisterCollectible(this);
+    if (USDTNavDistanceTable* distanceTable = GetWorld()->GetSubsystem<USDTNavDistanceTable>())
+        distanceTable->RegisterPointOfInterest(this);
+}
+
+void ASDTCollectible::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+    if (USDTCollectibleRegistry* registry = GetWorld()->GetSubsystem<USDTCollectibleRegistry>())
+        registry->UnregisterCollectible(this);
+    if (USDTNavDistanceTable* distanceTable = GetWorld()->GetSubsystem<USDTNavDistanceTable>())
+        distanceTable->UnregisterPointOfInterest(this);
+
+    Super::EndPlay(EndPlayReason);
+}
+
 void ASDTCollectible::Collect()
 {
     GetWorld()->GetTimerManager().SetTimer(m_CollectCooldownTimer, this, &ASDTCollectible::OnCooldownDone, m_CollectCooldownDuration, false);
 
     GetStaticMeshComponent()->SetVisibility(false);
-    ResetCurrentSeeker();
+
+    if (USDTCollectibleRegistry* registry = GetWorld()->GetSubsystem<USDTCollectibleRegistry>())
+        registry->SetCollectibleAvailable(this, false);
+
+    if (USDTGameEvents* events = GetWorld()->GetSubsystem<USDTGameEvents>())
+        events->OnCollectibleAvailabilityChanged.Broadcast(this, false);
 }
 
 void ASDTCollectible::OnCooldownDone()
@@ -21,19 +49,15 @@ void ASDTCollectible::OnCooldownDone()
     GetWorld()->GetTimerManager().ClearTimer(m_CollectCooldownTimer);
 
     GetStaticMeshComponent()->SetVisibility(true);
-}
 
-bool ASDTCollectible::IsOnCooldown()
-{
-    return m_CollectCooldownTimer.IsValid();
-}
+    if (USDTCollectibleRegistry* registry = GetWorld()->GetSubsystem<USDTCollectibleRegistry>())
+        registry->SetCollectibleAvailable(this, true);
 
-void ASDTCollectible::SetCurrentSeeker(FString label)
-{
-    m_currentSeeker = label;
+    if (USDTGameEvents* events = GetWorld()->GetSubsystem<USDTGameEvents>())
+        events->OnCollectibleAvailabilityChanged.Broadcast(this, true);
 }
 
-void ASDTCollectible::ResetCurrentSeeker()
+bool ASDTCollectible::IsOnCooldown()
 {
-    m_currentSeeker = FString();
+    return m_CollectCooldownTimer.IsValid();
 }
@@ -16,12 +16,15 @@ class SOFTDESIGNTRAINING_API ASDTCollectible : public AStaticMeshActor
 public:
     ASDTCollectible();
 
+    virtual void BeginPlay() override;
+    virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
     void Collect();
     void OnCooldownDone();
     bool IsOnCooldown();
-    void SetCurrentSeeker(FString label);
-    void ResetCurrentSeeker();
-    FString m_currentSeeker;
+
+    // Slot of the collectible in the reservation table of the collectible registry
+    int32 m_ReservationSlot = INDEX_NONE;
 
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = AI)
     float m_CollectCooldownDuration = 10.f;
@@ -0,0 +1,278 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "SDTCollectibleAssignment.h"
+#include "SoftDesignTraining.h"
+#include "SDTAIController.h"
+#include "SDTAIScheduler.h"
+#include "SDTCollectible.h"
+#include "SDTCollectibleRegistry.h"
+#include "SDTNavDistanceTable.h"
+#include "SDTUtilityScorer.h"
+#include "Async/Async.h"
+
+void USDTCollectibleAssignment::Deinitialize()
+{
+    // the solver only works on copies, but its result must not outlive the subsystem
+    if (m_PendingAssignment.IsValid())
+        m_PendingAssignment.Wait();
+
+    Super::Deinitialize();
+}
+
+ASDTCollectible* USDTCollectibleAssignment::GetAssignedCollectible(int32 agentId) const
+{
+    return m_Assignments.IsValidIndex(agentId) ? m_Assignments[agentId].Get() : nullptr;
+}
+
+bool USDTCollectibleAssignment::IsTickable() const
+{
+    const UWorld* world = GetWorld();
+    return !HasAnyFlags(RF_ClassDefaultObject) && world && world->IsGameWorld();
+}
+
+TStatId USDTCollectibleAssignment::GetStatId() const
+{
+    RETURN_QUICK_DECLARE_CYCLE_STAT(USDTCollectibleAssignment, STATGROUP_Tickables);
+}
+
+void USDTCollectibleAssignment::Tick(float deltaTime)
+{
+    if (m_PendingAssignment.IsValid())
+    {
+        if (!m_PendingAssignment.IsReady())
+            return;
+
+        ApplyAssignment(m_PendingAssignment.Get());
+        m_PendingAssignment = TFuture<TArray<int32>>();
+    }
+
+    m_TimeSinceLastPass += deltaTime;
+    if (m_TimeSinceLastPass >= m_AssignmentPeriod)
+    {
+        m_TimeSinceLastPass = 0.f;
+        StartAssignment();
+    }
+}
+
+/*
+ * Copies the locations of the pawns looking for a collectible and of the available collectibles, then solves the assignment on a worker thread
+ */
+void USDTCollectibleAssignment::StartAssignment()
+{
+    USDTAIScheduler* scheduler = GetWorld()->GetSubsystem<USDTAIScheduler>();
+    USDTCollectibleRegistry* registry = GetWorld()->GetSubsystem<USDTCollectibleRegistry>();
+    if (!scheduler || !registry)
+        return;
+
+    TArray<ASDTCollectible*> collectibles;
+    registry->GetAvailableCollectibles(collectibles);
+
+    FAssignmentInput input;
+    input.CandidateCount = FMath::Max(1, m_CandidateCount);
+    input.Epsilon = FMath::Max(KINDA_SMALL_NUMBER, m_AuctionEpsilon);
+    input.UnassignedCost = m_UnassignedCost;
+    input.CurrentTargetBonus = m_CurrentTargetBonus;
+
+    m_PendingCollectibles.Reset(collectibles.Num());
+    input.CollectibleLocations.Reserve(collectibles.Num());
+    for (ASDTCollectible* collectible : collectibles)
+    {
+        m_PendingCollectibles.Add(collectible);
+        input.CollectibleLocations.Add(FVector2D(collectible->GetActorLocation()));
+    }
+
+    m_PendingAgentIds.Reset();
+    TArray<FVector> agentLocations;
+    for (int32 i = 0; i < scheduler->GetControllerCount(); ++i)
+    {
+        const ASDTAIController* controller = Cast<ASDTAIController>(scheduler->GetController(i));
+        if (!controller || !controller->IsSeekingCollectible() || !controller->GetPawn() || controller->GetAgentId() == INDEX_NONE)
+            continue;
+
+        m_PendingAgentIds.Add(controller->GetAgentId());
+        agentLocations.Add(controller->GetPawn()->GetActorLocation());
+        input.AgentLocations.Add(FVector2D(agentLocations.Last()));
+        input.AgentCurrentTargets.Add(collectibles.Find(controller->GetCollectibleTarget()));
+    }
+
+    // navmesh distances between the pawns and the collectibles
+    const USDTNavDistanceTable* distanceTable = GetWorld()->GetSubsystem<USDTNavDistanceTable>();
+    if (distanceTable && distanceTable->IsBuilt())
+    {
+        TArray<int32> collectibleIndices;
+        collectibleIndices.Reserve(collectibles.Num());
+        for (ASDTCollectible* collectible : collectibles)
+        {
+            collectibleIndices.Add(distanceTable->GetPointOfInterestIndex(collectible));
+        }
+
+        input.AgentCollectibleDistances.Reserve(agentLocations.Num() * collectibles.Num());
+        for (const FVector& agentLocation : agentLocations)
+        {
+            const int32 anchor = distanceTable->FindAnchor(agentLocation);
+            for (int32 collectibleIndex : collectibleIndices)
+            {
+                input.AgentCollectibleDistances.Add(distanceTable->GetDistance(agentLocation, anchor, collectibleIndex));
+            }
+        }
+    }
+
+    if (m_PendingAgentIds.Num() == 0)
+    {
+        ApplyAssignment(TArray<int32>());
+        return;
+    }
+
+    m_PendingAssignment = Async(EAsyncExecution::ThreadPool, [input = MoveTemp(input)]() {
+        return SolveAuction(input);
+    });
+}
+
+void USDTCollectibleAssignment::ApplyAssignment(const TArray<int32>& agentCollectibles)
+{
+    for (TWeakObjectPtr<ASDTCollectible>& assignment : m_Assignments)
+    {
+        assignment.Reset();
+    }
+
+    for (int32 i = 0; i < agentCollectibles.Num(); ++i)
+    {
+        const int32 agentId = m_PendingAgentIds[i];
+        if (agentCollectibles[i] == INDEX_NONE)
+            continue;
+
+        if (agentId >= m_Assignments.Num())
+            m_Assignments.SetNum(agentId + 1);
+        m_Assignments[agentId] = m_PendingCollectibles[agentCollectibles[i]];
+    }
+}
+
+/*
+ * Forward auction (Bertsekas). Unassigned agents bid, one at a time, on the object with the best benefit minus price, raising
+ * its price by the difference with their second best option plus epsilon. The previous owner of the object gets back in the queue.
+ * Each agent also has a private dummy object worth -UnassignedCost, so every agent ends up with exactly one object.
+ * Returns the collectible index assigned to each agent, INDEX_NONE for the agents left with their dummy.
+ */
+TArray<int32> USDTCollectibleAssignment::SolveAuction(const FAssignmentInput& input)
+{
+    const int32 agentCount = input.AgentLocations.Num();
+    const int32 collectibleCount = input.CollectibleLocations.Num();
+    const int32 candidateCount = FMath::Min(input.CandidateCount, collectibleCount);
+
+    // nearest collectibles of each agent, with their benefit
+    struct FCandidate
+    {
+        int32 Object;
+        float Benefit;
+    };
+    TArray<FCandidate> candidates;
+    candidates.Reserve(agentCount * (candidateCount + 1));
+
+    FSDTUtilityCandidates collectibles;
+    collectibles.Reset(collectibleCount);
+    for (int32 collectible = 0; collectible < collectibleCount; ++collectible)
+    {
+        collectibles.SetLocation(collectible, input.CollectibleLocations[collectible]);
+    }
+
+    const bool useNavDistances = input.AgentCollectibleDistances.Num() == agentCount * collectibleCount;
+
+    FSDTUtilityScorer scorer;
+    TArray<int32> nearest;
+    TArray<float> benefits;
+    for (int32 agent = 0; agent < agentCount; ++agent)
+    {
+        scorer.Reset();
+        if (useNavDistances)
+        {
+            for (int32 collectible = 0; collectible < collectibleCount; ++collectible)
+            {
+                // the collectibles the table does not know yet stay candidates, only the unreachable ones are dropped
+                const float distance = input.AgentCollectibleDistances[agent * collectibleCount + collectible];
+                const float estimate = distance >= 0.f ? distance : FVector2D::Distance(input.AgentLocations[agent], input.CollectibleLocations[collectible]);
+                collectibles.SetValue(collectible, estimate);
+                collectibles.SetFlag(collectible, FSDTUtilityCandidates::Available, distance != MAX_FLT);
+            }
+            scorer.AddValue(-1.f).Require(FSDTUtilityCandidates::Available);
+        }
+        else
+        {
+            scorer.PreferNear(input.AgentLocations[agent]);
+        }
+        scorer.AddBonus(input.AgentCurrentTargets[agent], input.CurrentTargetBonus);
+        scorer.SelectTopK(collectibles, candidateCount, nearest, &benefits);
+
+        // every agent has the same number of candidates, the unreachable collectibles are replaced by the agent's dummy
+        for (int32 i = 0; i < candidateCount; ++i)
+        {
+            candidates.Add(nearest.IsValidIndex(i) ? FCandidate{ nearest[i], benefits[i] } : FCandidate{ collectibleCount + agent, -input.UnassignedCost });
+        }
+        candidates.Add({ collectibleCount + agent, -input.UnassignedCost });
+    }
+
+    const int32 candidatesPerAgent = candidateCount + 1;
+    const int32 objectCount = collectibleCount + agentCount;
+
+    TArray<float> prices;
+    prices.SetNumZeroed(objectCount);
+    TArray<int32> owners;
+    owners.Init(INDEX_NONE, objectCount);
+    TArray<int32> agentObjects;
+    agentObjects.Init(INDEX_NONE, agentCount);
+
+    TArray<int32> unassignedAgents;
+    unassignedAgents.Reserve(agentCount);
+    for (int32 agent = agentCount - 1; agent >= 0; --agent)
+    {
+        unassignedAgents.Add(agent);
+    }
+
+    // the auction ends in a bounded number of bids with a positive epsilon, the cap only protects against degenerate inputs
+    const int32 maxBids = agentCount * candidatesPerAgent * 64;
+    for (int32 bid = 0; bid < maxBids && unassignedAgents.Num() > 0; ++bid)
+    {
+        const int32 agent = unassignedAgents.Pop(false);
+
+        int32 bestObject = INDEX_NONE;
+        float bestValue = -MAX_FLT;
+        float secondValue = -MAX_FLT;
+
+        for (int32 i = 0; i < candidatesPerAgent; ++i)
+        {
+            const FCandidate& candidate = candidates[agent * candidatesPerAgent + i];
+            const float value = candidate.Benefit - prices[candidate.Object];
+            if (value > bestValue)
+            {
+                secondValue = bestValue;
+                bestValue = value;
+                bestObject = candidate.Object;
+            }
+            else if (value > secondValue)
+            {
+                secondValue = value;
+            }
+        }
+
+        if (secondValue == -MAX_FLT)
+            secondValue = bestValue - input.UnassignedCost;
+
+        prices[bestObject] += bestValue - secondValue + input.Epsilon;
+
+        const int32 previousOwner = owners[bestObject];
+        if (previousOwner != INDEX_NONE)
+        {
+            agentObjects[previousOwner] = INDEX_NONE;
+            unassignedAgents.Add(previousOwner);
+        }
+        owners[bestObject] = agent;
+        agentObjects[agent] = bestObject;
+    }
+
+    TArray<int32> agentCollectibles;
+    agentCollectibles.SetNumUninitialized(agentCount);
+    for (int32 agent = 0; agent < agentCount; ++agent)
+    {
+        agentCollectibles[agent] = agentObjects[agent] < collectibleCount ? agentObjects[agent] : INDEX_NONE;
+    }
+    return agentCollectibles;
+}
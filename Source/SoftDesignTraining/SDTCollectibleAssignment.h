@@ -0,0 +1,86 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Tickable.h"
+#include "Async/Future.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "SDTCollectibleAssignment.generated.h"
+
+class ASDTCollectible;
+
+/**
+ * Periodically assigns the available collectibles to all the pawns looking for one, in a single batch.
+ * Positions are gathered on the game thread and the assignment is solved on a worker thread with an auction:
+ * each pawn bids on its nearest collectibles and on a private "no collectible" option, so pawns outnumbering the
+ * collectibles are left without an assignment instead of competing. Pawns keep a bonus on the collectible they are
+ * already heading to, so the assignment does not make them retarget for small gains.
+ */
+UCLASS(config = Game)
+class SOFTDESIGNTRAINING_API USDTCollectibleAssignment : public UWorldSubsystem, public FTickableGameObject
+{
+    GENERATED_BODY()
+
+public:
+    virtual void Deinitialize() override;
+
+    // Collectible assigned to the agent by the last completed pass, null if there is none
+    ASDTCollectible* GetAssignedCollectible(int32 agentId) const;
+
+    virtual void Tick(float deltaTime) override;
+    virtual bool IsTickable() const override;
+    virtual TStatId GetStatId() const override;
+    virtual UWorld* GetTickableGameObjectWorld() const override { return GetWorld(); }
+
+    // Time between two assignment passes, in seconds
+    UPROPERTY(config)
+    float m_AssignmentPeriod = 0.5f;
+
+    // Number of nearest collectibles each pawn bids on
+    UPROPERTY(config)
+    int32 m_CandidateCount = 8;
+
+    // Minimum bid increment, in world units. The assignment is within (pawn count * epsilon) of the optimal total distance.
+    UPROPERTY(config)
+    float m_AuctionEpsilon = 10.f;
+
+    // Distance above which a pawn prefers having no collectible assigned
+    UPROPERTY(config)
+    float m_UnassignedCost = 100000.f;
+
+    // Distance bonus given to the collectible a pawn is already heading to
+    UPROPERTY(config)
+    float m_CurrentTargetBonus = 300.f;
+
+private:
+    struct FAssignmentInput
+    {
+        TArray<FVector2D> AgentLocations;
+        TArray<int32> AgentCurrentTargets;
+        TArray<FVector2D> CollectibleLocations;
+
+        // Navmesh distance estimates, indexed by agent * collectible count + collectible, negative when unknown and MAX_FLT when unreachable.
+        // Empty when the distance table is not built. The 2D distances are used instead of the missing ones.
+        TArray<float> AgentCollectibleDistances;
+        int32 CandidateCount;
+        float Epsilon;
+        float UnassignedCost;
+        float CurrentTargetBonus;
+    };
+
+    void StartAssignment();
+    void ApplyAssignment(const TArray<int32>& agentCollectibles);
+    static TArray<int32> SolveAuction(const FAssignmentInput& input);
+
+    TFuture<TArray<int32>> m_PendingAssignment;
+
+    // Agents and collectibles of the pending pass, in the order given to the solver
+    TArray<int32> m_PendingAgentIds;
+    TArray<TWeakObjectPtr<ASDTCollectible>> m_PendingCollectibles;
+
+    // Collectible assigned to each agent id
+    TArray<TWeakObjectPtr<ASDTCollectible>> m_Assignments;
+
+    float m_TimeSinceLastPass = 0.f;
+};
@@ -0,0 +1,197 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "SDTCollectibleRegistry.h"
+#include "SoftDesignTraining.h"
+#include "SDTCollectible.h"
+
+void USDTCollectibleRegistry::RegisterCollectible(ASDTCollectible* collectible)
+{
+    if (!collectible || m_Collectibles.Contains(collectible))
+        return;
+
+    m_Collectibles.Add(collectible);
+    collectible->m_ReservationSlot = m_Reservations.AllocateSlot();
+
+    if (!collectible->IsOnCooldown())
+        AddToGrid(collectible);
+}
+
+void USDTCollectibleRegistry::UnregisterCollectible(ASDTCollectible* collectible)
+{
+    if (m_Collectibles.RemoveSingleSwap(collectible) == 0)
+        return;
+
+    RemoveFromGrid(collectible);
+    m_Reservations.FreeSlot(collectible->m_ReservationSlot);
+    collectible->m_ReservationSlot = INDEX_NONE;
+}
+
+void USDTCollectibleRegistry::SetCollectibleAvailable(ASDTCollectible* collectible, bool available)
+{
+    if (!m_Collectibles.Contains(collectible))
+        return;
+
+    if (available)
+    {
+        AddToGrid(collectible);
+    }
+    else
+    {
+        // a collected collectible is no longer the target of the pawn that claimed it
+        RemoveFromGrid(collectible);
+        m_Reservations.ReleaseSlot(collectible->m_ReservationSlot);
+    }
+}
+
+/*
+ * Returns the registered collectible for a pointer read from a snapshot, nullptr once it is unregistered
+ */
+ASDTCollectible* USDTCollectibleRegistry::FindCollectible(const ASDTCollectible* collectible) const
+{
+    ASDTCollectible* const* registered = m_Collectibles.FindByPredicate([collectible](const ASDTCollectible* other) { return other == collectible; });
+    return registered ? *registered : nullptr;
+}
+
+bool USDTCollectibleRegistry::ClaimCollectible(const ASDTCollectible* collectible, int32 agentId)
+{
+    return collectible && m_Reservations.Claim(collectible->m_ReservationSlot, agentId);
+}
+
+bool USDTCollectibleRegistry::IsClaimedByOther(const ASDTCollectible* collectible, int32 agentId) const
+{
+    return collectible && m_Reservations.IsClaimedByOther(collectible->m_ReservationSlot, agentId);
+}
+
+/*
+ * Finds up to maxCount available collectibles, sorted from the nearest to the furthest (2D distance), and returns their reservation slots.
+ * The grid is visited ring by ring around the location and the search stops as soon as no unvisited cell can hold a nearer collectible.
+ * The rings are clamped to the bounds of the occupied cells, so a location far from the collectibles does not walk through empty rings.
+ * The slots without a location, registered after the locations were captured, are skipped.
+ */
+void USDTCollectibleRegistry::GetNearestAvailable(const FVector& location, const TArray<FVector>& slotLocations, int32 maxCount, TArray<int32>& outSlots) const
+{
+    outSlots.Reset();
+
+    const int32 availableCount = m_AvailableCollectibles.Num();
+    if (maxCount <= 0 || availableCount == 0)
+        return;
+
+    struct FCandidate
+    {
+        int32 Slot;
+        float DistSquared;
+    };
+    TArray<FCandidate, TInlineAllocator<32>> candidates;
+    auto sortCandidates = [&candidates]() {
+        candidates.Sort([](const FCandidate& candidate1, const FCandidate& candidate2) {
+            return candidate1.DistSquared < candidate2.DistSquared;
+        });
+    };
+
+    const FIntPoint centerCell = GetCell(location);
+    const FIntPoint minOffset = m_MinAvailableCell - centerCell;
+    const FIntPoint maxOffset = m_MaxAvailableCell - centerCell;
+    const int32 firstRing = FMath::Max3(0, FMath::Max(minOffset.X, -maxOffset.X), FMath::Max(minOffset.Y, -maxOffset.Y));
+    const int32 lastRing = FMath::Max(FMath::Max(-minOffset.X, maxOffset.X), FMath::Max(-minOffset.Y, maxOffset.Y));
+
+    int32 visitedCount = 0;
+    auto visitCell = [&](int32 x, int32 y) {
+        if (const TArray<int32>* cellSlots = m_AvailableCells.Find(FIntPoint(centerCell.X + x, centerCell.Y + y)))
+        {
+            visitedCount += cellSlots->Num();
+            for (int32 slot : *cellSlots)
+            {
+                if (slotLocations.IsValidIndex(slot))
+                    candidates.Add({ slot, FVector::DistSquared2D(location, slotLocations[slot]) });
+            }
+        }
+    };
+
+    for (int32 ring = firstRing; ring <= lastRing && visitedCount < availableCount; ++ring)
+    {
+        if (candidates.Num() >= maxCount)
+        {
+            // the cells of this ring are at least (ring - 1) cells away from the location
+            const float ringDistance = (ring - 1) * m_CellSize;
+            sortCandidates();
+            if (ringDistance > 0.f && candidates[maxCount - 1].DistSquared <= FMath::Square(ringDistance))
+                break;
+        }
+
+        if (ring == 0)
+        {
+            visitCell(0, 0);
+            continue;
+        }
+
+        // only the parts of the ring sides inside of the bounds
+        const int32 minX = FMath::Max(-ring, minOffset.X);
+        const int32 maxX = FMath::Min(ring, maxOffset.X);
+        const int32 minY = FMath::Max(-ring + 1, minOffset.Y);
+        const int32 maxY = FMath::Min(ring - 1, maxOffset.Y);
+        for (int32 x = minX; x <= maxX; ++x)
+        {
+            if (-ring >= minOffset.Y)
+                visitCell(x, -ring);
+            if (ring <= maxOffset.Y)
+                visitCell(x, ring);
+        }
+        for (int32 y = minY; y <= maxY; ++y)
+        {
+            if (-ring >= minOffset.X)
+                visitCell(-ring, y);
+            if (ring <= maxOffset.X)
+                visitCell(ring, y);
+        }
+    }
+
+    sortCandidates();
+
+    const int32 resultCount = FMath::Min(maxCount, candidates.Num());
+    outSlots.Reserve(resultCount);
+    for (int32 i = 0; i < resultCount; ++i)
+    {
+        outSlots.Add(candidates[i].Slot);
+    }
+}
+
+FIntPoint USDTCollectibleRegistry::GetCell(const FVector& location) const
+{
+    return FIntPoint(FMath::FloorToInt(location.X / m_CellSize), FMath::FloorToInt(location.Y / m_CellSize));
+}
+
+void USDTCollectibleRegistry::AddToGrid(ASDTCollectible* collectible)
+{
+    bool alreadyAvailable = false;
+    m_AvailableCollectibles.Add(collectible, &alreadyAvailable);
+
+    if (alreadyAvailable)
+        return;
+
+    const FIntPoint cell = GetCell(collectible->GetActorLocation());
+    if (m_AvailableCells.Num() == 0)
+    {
+        m_MinAvailableCell = cell;
+        m_MaxAvailableCell = cell;
+    }
+    else
+    {
+        m_MinAvailableCell = FIntPoint(FMath::Min(m_MinAvailableCell.X, cell.X), FMath::Min(m_MinAvailableCell.Y, cell.Y));
+        m_MaxAvailableCell = FIntPoint(FMath::Max(m_MaxAvailableCell.X, cell.X), FMath::Max(m_MaxAvailableCell.Y, cell.Y));
+    }
+    m_AvailableCells.FindOrAdd(cell).Add(collectible->m_ReservationSlot);
+}
+
+void USDTCollectibleRegistry::RemoveFromGrid(ASDTCollectible* collectible)
+{
+    if (m_AvailableCollectibles.Remove(collectible) == 0)
+        return;
+
+    const FIntPoint cell = GetCell(collectible->GetActorLocation());
+    if (TArray<int32>* cellSlots = m_AvailableCells.Find(cell))
+    {
+        cellSlots->RemoveSingleSwap(collectible->m_ReservationSlot);
+        if (cellSlots->Num() == 0)
+            m_AvailableCells.Remove(cell);
+    }
+}
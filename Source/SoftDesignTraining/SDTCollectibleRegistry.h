@@ -0,0 +1,66 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "SDTReservationTable.h"
+#include "SDTCollectibleRegistry.generated.h"
+
+class ASDTCollectible;
+
+/**
+ * Keeps track of the collectibles of the world.
+ * Available collectibles are bucketed in a 2D grid so the AI can find the nearest ones without iterating over all the actors.
+ * Pawns heading to a collectible claim it in a reservation table so the other pawns pick another one.
+ */
+UCLASS(config = Game)
+class SOFTDESIGNTRAINING_API USDTCollectibleRegistry : public UWorldSubsystem
+{
+    GENERATED_BODY()
+
+public:
+    void RegisterCollectible(ASDTCollectible* collectible);
+    void UnregisterCollectible(ASDTCollectible* collectible);
+    void SetCollectibleAvailable(ASDTCollectible* collectible, bool available);
+
+    // The distances are measured to the locations of the slots given, so a world snapshot can be searched from a worker thread while the game thread waits
+    void GetNearestAvailable(const FVector& location, const TArray<FVector>& slotLocations, int32 maxCount, TArray<int32>& outSlots) const;
+    int32 GetAvailableCount() const { return m_AvailableCollectibles.Num(); }
+    void GetAvailableCollectibles(TArray<ASDTCollectible*>& outCollectibles) const { outCollectibles = m_AvailableCollectibles.Array(); }
+    bool IsAvailable(const ASDTCollectible* collectible) const { return m_AvailableCollectibles.Contains(const_cast<ASDTCollectible*>(collectible)); }
+    const TArray<ASDTCollectible*>& GetCollectibles() const { return m_Collectibles; }
+    ASDTCollectible* FindCollectible(const ASDTCollectible* collectible) const;
+    int32 GetSlotCount() const { return m_Reservations.GetSlotCount(); }
+
+    // Reservations, claim and release can be called from any thread
+    int32 RegisterAgent() { return m_Reservations.AllocateAgent(); }
+    void UnregisterAgent(int32 agentId) { m_Reservations.FreeAgent(agentId); }
+    bool ClaimCollectible(const ASDTCollectible* collectible, int32 agentId);
+    void ReleaseClaim(int32 agentId) { m_Reservations.ReleaseAgent(agentId); }
+    bool IsClaimedByOther(const ASDTCollectible* collectible, int32 agentId) const;
+    bool IsSlotClaimedByOther(int32 slot, int32 agentId) const { return m_Reservations.IsClaimedByOther(slot, agentId); }
+
+    // Size of a grid cell, in world units
+    UPROPERTY(config)
+    float m_CellSize = 1000.f;
+
+private:
+    FIntPoint GetCell(const FVector& location) const;
+    void AddToGrid(ASDTCollectible* collectible);
+    void RemoveFromGrid(ASDTCollectible* collectible);
+
+    UPROPERTY()
+    TArray<ASDTCollectible*> m_Collectibles;
+
+    // Reservation slots of the available collectibles, by grid cell
+    TMap<FIntPoint, TArray<int32>> m_AvailableCells;
+
+    // Bounds of the cells holding available collectibles, the search never visits a ring outside of them.
+    // They only grow until the grid is empty, an outdated bound only adds a few empty cells to the search.
+    FIntPoint m_MinAvailableCell = FIntPoint::ZeroValue;
+    FIntPoint m_MaxAvailableCell = FIntPoint::ZeroValue;
+    TSet<ASDTCollectible*> m_AvailableCollectibles;
+
+    FSDTReservationTable m_Reservations;
+};
@@ -2,6 +2,8 @@
 
 #include "SDTFleeLocation.h"
 #include "SoftDesignTraining.h"
+#include "SDTFleeTable.h"
+#include "SDTNavDistanceTable.h"
 
 
 // Sets default values
@@ -16,7 +18,21 @@ ASDTFleeLocation::ASDTFleeLocation()
 void ASDTFleeLocation::BeginPlay()
 {
 	Super::BeginPlay();
-	
+
+	if (USDTFleeTable* fleeTable = GetWorld()->GetSubsystem<USDTFleeTable>())
+		fleeTable->RegisterFleeLocation(this);
+	if (USDTNavDistanceTable* distanceTable = GetWorld()->GetSubsystem<USDTNavDistanceTable>())
+		distanceTable->RegisterPointOfInterest(this);
+}
+
+void ASDTFleeLocation::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (USDTFleeTable* fleeTable = GetWorld()->GetSubsystem<USDTFleeTable>())
+		fleeTable->UnregisterFleeLocation(this);
+	if (USDTNavDistanceTable* distanceTable = GetWorld()->GetSubsystem<USDTNavDistanceTable>())
+		distanceTable->UnregisterPointOfInterest(this);
+
+	Super::EndPlay(EndPlayReason);
 }
 
 // Called every frame
@@ -0,0 +1,266 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "SDTFleeTable.h"
+#include "SoftDesignTraining.h"
+#include "SDTFleeLocation.h"
+#include "SDTUtilityScorer.h"
+#include "NavigationSystem.h"
+#include "NavigationData.h"
+
+void USDTFleeTable::RegisterFleeLocation(ASDTFleeLocation* fleeLocation)
+{
+    if (!fleeLocation || m_FleeLocations.Contains(fleeLocation))
+        return;
+
+    m_FleeLocations.Add(fleeLocation);
+    ++m_FleeLocationVersion;
+    RequestBuild();
+}
+
+void USDTFleeTable::UnregisterFleeLocation(ASDTFleeLocation* fleeLocation)
+{
+    if (m_FleeLocations.Remove(fleeLocation) == 0)
+        return;
+
+    ++m_FleeLocationVersion;
+    RequestBuild();
+}
+
+/*
+ * Defers the build to the next tick so all the flee locations of the level are registered before it starts
+ */
+void USDTFleeTable::RequestBuild()
+{
+    m_BuildRequested = true;
+}
+
+void USDTFleeTable::OnNavigationGenerationFinished(ANavigationData* navData)
+{
+    RequestBuild();
+}
+
+bool USDTFleeTable::IsTickable() const
+{
+    const UWorld* world = GetWorld();
+    return !HasAnyFlags(RF_ClassDefaultObject) && world && world->IsGameWorld();
+}
+
+TStatId USDTFleeTable::GetStatId() const
+{
+    RETURN_QUICK_DECLARE_CYCLE_STAT(USDTFleeTable, STATGROUP_Tickables);
+}
+
+/*
+ * Starts the build over when requested, then lays the regions and keeps the route queries flowing
+ */
+void USDTFleeTable::Tick(float deltaTime)
+{
+    if (m_BuildRequested)
+        StartBuild();
+
+    if (m_RegionBuildRunning)
+        ContinueRegionBuild();
+
+    if (m_RoutesRunning)
+        SendQueries();
+}
+
+/*
+ * Drops the build in progress and lays the regions again, the table in use is kept until the new one is complete
+ */
+void USDTFleeTable::StartBuild()
+{
+    UNavigationSystemV1* navSystem = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld());
+    if (!navSystem)
+        return;
+
+    // rebuild the table whenever the navmesh changes
+    navSystem->OnNavigationGenerationFinishedDelegate.AddUniqueDynamic(this, &USDTFleeTable::OnNavigationGenerationFinished);
+
+    const ANavigationData* navData = navSystem->GetDefaultNavDataInstance(FNavigationSystem::DontCreate);
+    if (!navData || navSystem->IsNavigationBuildInProgress())
+        return;
+
+    // the running queries of the previous build are dropped
+    m_BuildRequested = false;
+    ++m_BuildSerial;
+    m_RoutesRunning = false;
+    m_QueuedRoutes.Reset();
+    m_NextRoute = 0;
+    m_PendingRoutes.Reset();
+
+    m_PendingFleeLocations = m_FleeLocations;
+    m_PendingFleeLocationPositions.Reset(m_PendingFleeLocations.Num());
+    for (const ASDTFleeLocation* fleeLocation : m_PendingFleeLocations)
+    {
+        m_PendingFleeLocationPositions.Add(fleeLocation->GetActorLocation());
+    }
+
+    m_PendingRegions.Reset();
+    if (m_PendingFleeLocations.Num() > 0)
+        m_PendingRegions.BeginBuild(navData->GetBounds(), m_RegionSize, false);
+
+    m_RegionBuildRunning = m_PendingRegions.GetCellCount() > 0;
+    if (!m_RegionBuildRunning)
+        FinishBuild();
+}
+
+/*
+ * Projects regions within the frame budget, on the game thread where the navmesh is not modified under the queries
+ */
+void USDTFleeTable::ContinueRegionBuild()
+{
+    const UNavigationSystemV1* navSystem = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld());
+    const ANavigationData* navData = navSystem ? navSystem->GetDefaultNavDataInstance(FNavigationSystem::DontCreate) : nullptr;
+    if (!navData || navSystem->IsNavigationBuildInProgress())
+        return;
+
+    if (!m_PendingRegions.ContinueBuild(*navSystem, *navData, m_RegionBuildBudgetMs / 1000.0))
+        return;
+
+    m_RegionBuildRunning = false;
+    QueueRoutes();
+}
+
+/*
+ * Queues a route query from each walkable region to each flee location, the routes of the other regions stay unreachable
+ */
+void USDTFleeTable::QueueRoutes()
+{
+    const int32 fleeCount = m_PendingFleeLocations.Num();
+    m_PendingRoutes.Reset();
+    m_PendingRoutes.SetNum(m_PendingRegions.GetCellCount() * fleeCount);
+
+    for (int32 regionIndex = 0; regionIndex < m_PendingRegions.GetCellCount(); ++regionIndex)
+    {
+        if (!m_PendingRegions.IsWalkable(regionIndex))
+            continue;
+
+        for (int32 fleeIndex = 0; fleeIndex < fleeCount; ++fleeIndex)
+        {
+            m_QueuedRoutes.Add(regionIndex * fleeCount + fleeIndex);
+        }
+    }
+
+    m_RemainingRoutes = m_QueuedRoutes.Num();
+    m_RoutesRunning = m_RemainingRoutes > 0;
+    if (!m_RoutesRunning)
+        FinishBuild();
+}
+
+void USDTFleeTable::SendQueries()
+{
+    if (m_NextRoute >= m_QueuedRoutes.Num())
+        return;
+
+    UNavigationSystemV1* navSystem = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld());
+    const ANavigationData* navData = navSystem ? navSystem->GetDefaultNavDataInstance(FNavigationSystem::DontCreate) : nullptr;
+    if (!navData)
+        return;
+
+    const int32 fleeCount = m_PendingFleeLocations.Num();
+    const int32 maxQueriesInFlight = FMath::Max(1, m_MaxQueriesInFlight);
+    while (m_NextRoute < m_QueuedRoutes.Num() && m_PendingQueries < maxQueriesInFlight)
+    {
+        const int32 routeIndex = m_QueuedRoutes[m_NextRoute++];
+        const FVector& from = m_PendingRegions.GetCellLocation(routeIndex / fleeCount);
+        const FVector& to = m_PendingFleeLocationPositions[routeIndex % fleeCount];
+
+        FPathFindingQuery pathQuery(this, *navData, from, to, navData->GetDefaultQueryFilter());
+        ++m_PendingQueries;
+        navSystem->FindPathAsync(navData->GetConfig(), pathQuery, FNavPathQueryDelegate::CreateUObject(this, &USDTFleeTable::OnRouteFound, routeIndex, m_BuildSerial));
+    }
+}
+
+void USDTFleeTable::OnRouteFound(uint32 queryId, ENavigationQueryResult::Type result, FNavPathSharedPtr path, int32 routeIndex, uint32 serial)
+{
+    --m_PendingQueries;
+
+    // a newer build started since the query was sent
+    if (serial != m_BuildSerial)
+        return;
+
+    if (result == ENavigationQueryResult::Success)
+        m_PendingRoutes[routeIndex] = MakeRoute(path);
+
+    if (--m_RemainingRoutes == 0)
+    {
+        m_RoutesRunning = false;
+        FinishBuild();
+    }
+}
+
+void USDTFleeTable::FinishBuild()
+{
+    m_Regions = MoveTemp(m_PendingRegions);
+    m_PendingRegions.Reset();
+    m_BuiltFleeLocations = MoveTemp(m_PendingFleeLocations);
+    m_PendingFleeLocations.Reset();
+    m_BuiltFleeLocationPositions = MoveTemp(m_PendingFleeLocationPositions);
+    m_PendingFleeLocationPositions.Reset();
+    m_Routes = MoveTemp(m_PendingRoutes);
+    m_PendingRoutes.Reset();
+    m_QueuedRoutes.Reset();
+    m_NextRoute = 0;
+
+    UE_LOG(LogSoftDesignTraining, Log, TEXT("Flee table built: %d regions, %d flee locations"), m_Regions.GetCellCount(), m_BuiltFleeLocations.Num());
+}
+
+USDTFleeTable::FFleeRoute USDTFleeTable::MakeRoute(const FNavPathSharedPtr& path)
+{
+    FFleeRoute route;
+
+    if (path.IsValid() && path->IsValid() && !path->IsPartial())
+    {
+        const TArray<FNavPathPoint>& pathPoints = path->GetPathPoints();
+        if (pathPoints.Num() >= 2)
+        {
+            route.FirstSegmentDirection = FVector2D(pathPoints[1].Location - pathPoints[0].Location).GetSafeNormal();
+            route.PathLength = path->GetLength();
+        }
+    }
+    return route;
+}
+
+void USDTFleeTable::GetSafeFleeLocations(const FVector& fromLocation, const FVector& threatLocation, float maxThreatAngle, int32 maxCount, TArray<ASDTFleeLocation*>& outFleeLocations) const
+{
+    outFleeLocations.Reset();
+
+    // registrations since the last build change the flee locations but not the routes
+    const int32 fleeCount = m_BuiltFleeLocations.Num();
+    if (fleeCount == 0 || m_Routes.Num() != m_Regions.GetCellCount() * fleeCount)
+        return;
+
+    const int32 regionIndex = m_Regions.FindNearestWalkableCell(fromLocation);
+
+    FSDTUtilityCandidates candidates;
+    candidates.Reset(fleeCount);
+    for (int32 fleeIndex = 0; fleeIndex < fleeCount; ++fleeIndex)
+    {
+        candidates.SetLocation(fleeIndex, FVector2D(m_BuiltFleeLocationPositions[fleeIndex]));
+
+        if (regionIndex != INDEX_NONE)
+        {
+            const FFleeRoute& route = m_Routes[regionIndex * fleeCount + fleeIndex];
+            candidates.SetDirection(fleeIndex, route.FirstSegmentDirection);
+            candidates.SetFlag(fleeIndex, FSDTUtilityCandidates::Available, route.PathLength >= 0.f);
+        }
+    }
+
+    // furthest from the threat first, without a region every flee location is kept and left to the path query confirmation
+    FSDTUtilityScorer scorer;
+    scorer.PreferFar(FVector2D(threatLocation));
+    if (regionIndex != INDEX_NONE)
+        scorer.RejectToward(FVector2D(threatLocation - fromLocation).GetSafeNormal(), maxThreatAngle).Require(FSDTUtilityCandidates::Available);
+
+    TArray<int32> fleeIndices;
+    scorer.SelectTopK(candidates, maxCount, fleeIndices);
+
+    outFleeLocations.Reserve(fleeIndices.Num());
+    for (int32 fleeIndex : fleeIndices)
+    {
+        // destroyed flee locations are nulled by the garbage collector until the rebuild
+        if (m_BuiltFleeLocations[fleeIndex])
+            outFleeLocations.Add(m_BuiltFleeLocations[fleeIndex]);
+    }
+}
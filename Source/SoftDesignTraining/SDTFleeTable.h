@@ -0,0 +1,110 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Tickable.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "NavigationSystemTypes.h"
+#include "SDTNavGrid.h"
+#include "SDTFleeTable.generated.h"
+
+class ANavigationData;
+class ASDTFleeLocation;
+
+/**
+ * Flee location safety table, built when the level is loaded and whenever the navmesh or the flee locations change.
+ * The navigable area is split in coarse regions and, for every region, the navmesh route to each flee location is stored
+ * (length and direction of its first segment). Fleeing then only needs a table scan instead of one path query per flee location.
+ * The regions are laid a few per frame, then the routes are filled by asynchronous path queries; the table in use is kept until
+ * the new one is complete.
+ */
+UCLASS(config = Game)
+class SOFTDESIGNTRAINING_API USDTFleeTable : public UWorldSubsystem, public FTickableGameObject
+{
+    GENERATED_BODY()
+
+public:
+    void RegisterFleeLocation(ASDTFleeLocation* fleeLocation);
+    void UnregisterFleeLocation(ASDTFleeLocation* fleeLocation);
+
+    bool IsBuilt() const { return m_Regions.IsBuilt(); }
+    const TArray<ASDTFleeLocation*>& GetFleeLocations() const { return m_FleeLocations; }
+
+    // Incremented whenever a flee location is registered or unregistered
+    uint32 GetFleeLocationVersion() const { return m_FleeLocationVersion; }
+
+    // Returns up to maxCount reachable flee locations, furthest from the threat first, whose route from the region of fromLocation does not start toward the threat.
+    // Only reads the table as built, flee locations registered since then are ignored until the next build.
+    void GetSafeFleeLocations(const FVector& fromLocation, const FVector& threatLocation, float maxThreatAngle, int32 maxCount, TArray<ASDTFleeLocation*>& outFleeLocations) const;
+
+    virtual void Tick(float deltaTime) override;
+    virtual bool IsTickable() const override;
+    virtual TStatId GetStatId() const override;
+    virtual UWorld* GetTickableGameObjectWorld() const override { return GetWorld(); }
+
+    // Size of a region, in world units
+    UPROPERTY(config)
+    float m_RegionSize = 500.f;
+
+    // Maximum number of route queries running at the same time
+    UPROPERTY(config)
+    int32 m_MaxQueriesInFlight = 64;
+
+    // Game thread time spent laying the regions over the navmesh each frame, in milliseconds
+    UPROPERTY(config)
+    float m_RegionBuildBudgetMs = 1.f;
+
+private:
+    struct FFleeRoute
+    {
+        FVector2D FirstSegmentDirection = FVector2D::ZeroVector;
+        float PathLength = -1.f;
+    };
+
+    static FFleeRoute MakeRoute(const FNavPathSharedPtr& path);
+    void RequestBuild();
+    void StartBuild();
+    void ContinueRegionBuild();
+    void QueueRoutes();
+    void SendQueries();
+    void OnRouteFound(uint32 queryId, ENavigationQueryResult::Type result, FNavPathSharedPtr path, int32 routeIndex, uint32 serial);
+    void FinishBuild();
+
+    UFUNCTION()
+    void OnNavigationGenerationFinished(ANavigationData* navData);
+
+    UPROPERTY()
+    TArray<ASDTFleeLocation*> m_FleeLocations;
+    uint32 m_FleeLocationVersion = 0;
+
+    FSDTNavGrid m_Regions;
+
+    // Flee locations the routes were built for, registrations only take effect at the next build
+    UPROPERTY()
+    TArray<ASDTFleeLocation*> m_BuiltFleeLocations;
+    TArray<FVector> m_BuiltFleeLocationPositions;
+
+    // Routes from every region to every built flee location, indexed by regionIndex * builtFleeLocationCount + fleeIndex
+    TArray<FFleeRoute> m_Routes;
+
+    // Table being built, replacing the one in use once all its routes are known
+    FSDTNavGrid m_PendingRegions;
+    UPROPERTY()
+    TArray<ASDTFleeLocation*> m_PendingFleeLocations;
+    TArray<FVector> m_PendingFleeLocationPositions;
+    TArray<FFleeRoute> m_PendingRoutes;
+
+    // Route queries waiting to be sent, in order, and the routes still unknown
+    TArray<int32> m_QueuedRoutes;
+    int32 m_NextRoute = 0;
+    int32 m_RemainingRoutes = 0;
+    int32 m_PendingQueries = 0;
+
+    // Incremented whenever a build starts, the results of the queries of the previous build are dropped
+    uint32 m_BuildSerial = 0;
+
+    bool m_RegionBuildRunning = false;
+    bool m_RoutesRunning = false;
+    bool m_BuildRequested = false;
+};
@@ -0,0 +1,29 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "SDTGameEvents.generated.h"
+
+class ASDTCollectible;
+class ASoftDesignTrainingCharacter;
+class ASoftDesignTrainingMainCharacter;
+
+DECLARE_MULTICAST_DELEGATE_TwoParams(FSDTOnCollectibleAvailabilityChanged, ASDTCollectible* /*collectible*/, bool /*available*/);
+DECLARE_MULTICAST_DELEGATE_TwoParams(FSDTOnPowerUpChanged, ASoftDesignTrainingMainCharacter* /*player*/, bool /*poweredUp*/);
+DECLARE_MULTICAST_DELEGATE_OneParam(FSDTOnCharacterDied, ASoftDesignTrainingCharacter* /*character*/);
+
+/**
+ * Gameplay events the AI reacts to, so controllers replan when something changes instead of polling the world
+ */
+UCLASS()
+class SOFTDESIGNTRAINING_API USDTGameEvents : public UWorldSubsystem
+{
+    GENERATED_BODY()
+
+public:
+    FSDTOnCollectibleAvailabilityChanged OnCollectibleAvailabilityChanged;
+    FSDTOnPowerUpChanged OnPowerUpChanged;
+    FSDTOnCharacterDied OnCharacterDied;
+};
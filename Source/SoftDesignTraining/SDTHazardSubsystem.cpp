@@ -0,0 +1,124 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "SDTHazardSubsystem.h"
+#include "SoftDesignTraining.h"
+#include "SDTProjectileSpawner.h"
+
+void USDTHazardSubsystem::RegisterSpawner(const ASDTProjectileSpawner* spawner, float firstShotTime)
+{
+    if (!spawner)
+        return;
+
+    UnregisterSpawner(spawner);
+
+    const FVector velocity = spawner->GetShotVelocity();
+    const float speed = velocity.Size2D();
+    const float period = spawner->GetTimeToShoot();
+    if (speed <= KINDA_SMALL_NUMBER || period <= KINDA_SMALL_NUMBER)
+        return;
+
+    // each projectile flies for a whole pool of periods before being reset to the spawner
+    const float lifeTime = spawner->GetMaxSimultaneousProjectiles() * period;
+    m_Lanes.Add({ spawner, spawner->GetActorLocation(), velocity, FVector2D(velocity) / speed, speed, speed * lifeTime, period, firstShotTime });
+}
+
+void USDTHazardSubsystem::UnregisterSpawner(const ASDTProjectileSpawner* spawner)
+{
+    m_Lanes.RemoveAll([spawner](const FLane& lane) { return lane.Spawner == spawner; });
+}
+
+/*
+ * Lane points within clearance of the segment are all within clearance of its projection on the lane, so the projected
+ * interval widened by the clearance is a conservative range of distances to the spawner.
+ */
+bool USDTHazardSubsystem::GetPassageWindow(const FLane& lane, const FVector& from, const FVector& to, float clearance, float& outWindowStart, float& outWindowEnd) const
+{
+    const float segmentZ = (from.Z + to.Z) * 0.5f;
+    if (FMath::Abs(segmentZ - lane.Origin.Z) > m_LaneHeightTolerance)
+        return false;
+
+    const float reach = clearance + m_ProjectileRadius;
+    const FVector laneEnd = lane.Origin + FVector(lane.Direction * lane.Length, 0.f);
+
+    FVector segmentPoint, lanePoint;
+    FMath::SegmentDistToSegmentSafe(FVector(FVector2D(from), 0.f), FVector(FVector2D(to), 0.f), FVector(FVector2D(lane.Origin), 0.f), FVector(FVector2D(laneEnd), 0.f), segmentPoint, lanePoint);
+    if (FVector::DistSquared(segmentPoint, lanePoint) > FMath::Square(reach))
+        return false;
+
+    const float fromDistance = FVector2D::DotProduct(FVector2D(from - lane.Origin), lane.Direction);
+    const float toDistance = FVector2D::DotProduct(FVector2D(to - lane.Origin), lane.Direction);
+    const float minDistance = FMath::Max(0.f, FMath::Min(fromDistance, toDistance) - reach);
+    const float maxDistance = FMath::Min(lane.Length, FMath::Max(fromDistance, toDistance) + reach);
+
+    outWindowStart = minDistance / lane.Speed - m_TimeMargin;
+    outWindowEnd = maxDistance / lane.Speed + m_TimeMargin;
+    return true;
+}
+
+/*
+ * The projectile shot at time s is near the segment during [s + windowStart, s + windowEnd]. The crossing is unsafe if
+ * a shot time of the lane, FirstShotTime + k * Period with k >= 0, falls in [startTime - windowEnd, endTime - windowStart].
+ */
+bool USDTHazardSubsystem::IsSegmentSafe(const FVector& from, const FVector& to, float startTime, float endTime, float clearance) const
+{
+    for (const FLane& lane : m_Lanes)
+    {
+        float windowStart, windowEnd;
+        if (!GetPassageWindow(lane, from, to, clearance, windowStart, windowEnd))
+            continue;
+
+        const int32 firstShot = FMath::Max(0, FMath::CeilToInt((startTime - windowEnd - lane.FirstShotTime) / lane.Period));
+        const int32 lastShot = FMath::FloorToInt((endTime - windowStart - lane.FirstShotTime) / lane.Period);
+        if (firstShot <= lastShot)
+            return false;
+    }
+    return true;
+}
+
+/*
+ * Moves the crossing time past the blocking passages until it is free for all the lanes
+ */
+float USDTHazardSubsystem::FindSafeCrossingTime(const FVector& from, const FVector& to, float startTime, float crossingDuration, float clearance, float maxWait) const
+{
+    float crossingTime = startTime;
+
+    for (int32 iteration = 0; iteration < 32 && crossingTime <= startTime + maxWait; ++iteration)
+    {
+        float nextCrossingTime = crossingTime;
+
+        for (const FLane& lane : m_Lanes)
+        {
+            float windowStart, windowEnd;
+            if (!GetPassageWindow(lane, from, to, clearance, windowStart, windowEnd))
+                continue;
+
+            const int32 firstShot = FMath::Max(0, FMath::CeilToInt((crossingTime - windowEnd - lane.FirstShotTime) / lane.Period));
+            const int32 lastShot = FMath::FloorToInt((crossingTime + crossingDuration - windowStart - lane.FirstShotTime) / lane.Period);
+            if (firstShot <= lastShot)
+            {
+                // wait for the first blocking projectile to be past the segment, the gap before the next one is checked on the next iteration
+                nextCrossingTime = FMath::Max(nextCrossingTime, lane.FirstShotTime + firstShot * lane.Period + windowEnd + KINDA_SMALL_NUMBER);
+            }
+        }
+
+        if (nextCrossingTime == crossingTime)
+            return crossingTime;
+
+        crossingTime = nextCrossingTime;
+    }
+    return -1.f;
+}
+
+void USDTHazardSubsystem::GetSpawnerStates(float time, TArray<FVector>& outLocations, TArray<FVector>& outShotVelocities, TArray<float>& outNextShotTimes) const
+{
+    outLocations.Reset(m_Lanes.Num());
+    outShotVelocities.Reset(m_Lanes.Num());
+    outNextShotTimes.Reset(m_Lanes.Num());
+    for (const FLane& lane : m_Lanes)
+    {
+        const int32 nextShot = FMath::Max(0, FMath::CeilToInt((time - lane.FirstShotTime) / lane.Period));
+        outLocations.Add(lane.Origin);
+        outShotVelocities.Add(lane.ShotVelocity);
+        outNextShotTimes.Add(lane.FirstShotTime + nextShot * lane.Period);
+    }
+}
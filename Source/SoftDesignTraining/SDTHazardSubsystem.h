@@ -0,0 +1,64 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "SDTHazardSubsystem.generated.h"
+
+class ASDTProjectileSpawner;
+
+/**
+ * Predicts where the spawner projectiles are without looking at them.
+ * A spawner fires every period from its first shot time and recycles its oldest projectile once its pool is full, so its
+ * projectiles always sit on a lane of fixed length at known distances from the spawner. Whether a pawn can cross a
+ * segment during a time window is then a lattice test on the shot times, in constant time per spawner.
+ */
+UCLASS(config = Game)
+class SOFTDESIGNTRAINING_API USDTHazardSubsystem : public UWorldSubsystem
+{
+    GENERATED_BODY()
+
+public:
+    void RegisterSpawner(const ASDTProjectileSpawner* spawner, float firstShotTime);
+    void UnregisterSpawner(const ASDTProjectileSpawner* spawner);
+
+    // True if no projectile comes within clearance of the segment between startTime and endTime (world time, in seconds)
+    bool IsSegmentSafe(const FVector& from, const FVector& to, float startTime, float endTime, float clearance) const;
+
+    // Earliest time after startTime at which the segment can be crossed in crossingDuration, negative if there is none before startTime + maxWait
+    float FindSafeCrossingTime(const FVector& from, const FVector& to, float startTime, float crossingDuration, float clearance, float maxWait) const;
+
+    // Location, shot velocity and time of the next shot after the given time (world time, in seconds) of every registered spawner
+    void GetSpawnerStates(float time, TArray<FVector>& outLocations, TArray<FVector>& outShotVelocities, TArray<float>& outNextShotTimes) const;
+
+    // Radius of the projectiles
+    UPROPERTY(config)
+    float m_ProjectileRadius = 50.f;
+
+    // Lanes further than this height from the segment are ignored
+    UPROPERTY(config)
+    float m_LaneHeightTolerance = 200.f;
+
+    // Time added on both sides of the projectile passages, covering the spawner scheduler deferring shots
+    UPROPERTY(config)
+    float m_TimeMargin = 0.1f;
+
+private:
+    struct FLane
+    {
+        const ASDTProjectileSpawner* Spawner;
+        FVector Origin;
+        FVector ShotVelocity;
+        FVector2D Direction;
+        float Speed;
+        float Length;
+        float Period;
+        float FirstShotTime;
+    };
+
+    // Time window, relative to a shot time, during which the projectile of that shot is near the segment. False if it never is.
+    bool GetPassageWindow(const FLane& lane, const FVector& from, const FVector& to, float clearance, float& outWindowStart, float& outWindowEnd) const;
+
+    TArray<FLane> m_Lanes;
+};
@@ -0,0 +1,165 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "SDTJumpTable.h"
+#include "SoftDesignTraining.h"
+#include "SDTNavArea_Jump.h"
+#include "Curves/CurveFloat.h"
+#include "EngineUtils.h"
+#include "NavigationSystem.h"
+#include "NavigationData.h"
+#include "Navigation/NavLinkProxy.h"
+#include "TimerManager.h"
+
+FVector FSDTJumpTrajectory::GetLocation(float progress) const
+{
+    const float sample = FMath::Clamp(progress, 0.f, 1.f) * (Samples.Num() - 1);
+    const int32 sampleIndex = FMath::Min(FMath::FloorToInt(sample), Samples.Num() - 2);
+    return FMath::Lerp(Samples[sampleIndex], Samples[sampleIndex + 1], sample - sampleIndex);
+}
+
+int32 USDTJumpTable::RegisterJumpProfile(UCurveFloat* jumpCurve, float apexHeight)
+{
+    if (!jumpCurve)
+        return INDEX_NONE;
+
+    const int32 existingIndex = m_Profiles.IndexOfByPredicate([jumpCurve, apexHeight](const FJumpProfile& profile) {
+        return profile.Curve == jumpCurve && profile.ApexHeight == apexHeight;
+    });
+    if (existingIndex != INDEX_NONE)
+        return existingIndex;
+
+    m_ProfileCurves.AddUnique(jumpCurve);
+    RequestBuild();
+    return m_Profiles.Add({ jumpCurve, apexHeight });
+}
+
+/*
+ * Defers the build to the next tick so all the controllers of the level have registered their profile before it runs
+ */
+void USDTJumpTable::RequestBuild()
+{
+    UWorld* world = GetWorld();
+    if (m_BuildRequested || !world || !world->IsGameWorld())
+        return;
+
+    m_BuildRequested = true;
+    world->GetTimerManager().SetTimerForNextTick(this, &USDTJumpTable::Build);
+}
+
+void USDTJumpTable::OnNavigationGenerationFinished(ANavigationData* navData)
+{
+    RequestBuild();
+}
+
+void USDTJumpTable::Build()
+{
+    m_BuildRequested = false;
+    m_Links.Reset();
+    m_Trajectories.Reset();
+    m_BakedProfileCount = 0;
+
+    // rebuild the table whenever the navmesh changes
+    if (UNavigationSystemV1* navSystem = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld()))
+        navSystem->OnNavigationGenerationFinishedDelegate.AddUniqueDynamic(this, &USDTJumpTable::OnNavigationGenerationFinished);
+
+    for (TActorIterator<ANavLinkProxy> it(GetWorld()); it; ++it)
+    {
+        const FTransform& proxyTransform = it->GetActorTransform();
+        for (const FNavigationLink& link : it->PointLinks)
+        {
+            const UClass* areaClass = link.GetAreaClass();
+            if (!areaClass || !areaClass->IsChildOf(USDTNavArea_Jump::StaticClass()))
+                continue;
+
+            const FVector left = proxyTransform.TransformPosition(link.Left);
+            const FVector right = proxyTransform.TransformPosition(link.Right);
+            if (link.Direction != ENavLinkDirection::RightToLeft)
+                m_Links.Emplace(left, right);
+            if (link.Direction != ENavLinkDirection::LeftToRight)
+                m_Links.Emplace(right, left);
+        }
+    }
+
+    const int32 profileCount = m_Profiles.Num();
+    m_Trajectories.SetNum(m_Links.Num() * profileCount);
+    m_BakedProfileCount = profileCount;
+
+    int32 blockedCount = 0;
+    for (int32 linkIndex = 0; linkIndex < m_Links.Num(); ++linkIndex)
+    {
+        for (int32 profileIndex = 0; profileIndex < profileCount; ++profileIndex)
+        {
+            FSDTJumpTrajectory& trajectory = m_Trajectories[linkIndex * profileCount + profileIndex];
+            BakeTrajectory(m_Links[linkIndex].Key, m_Links[linkIndex].Value, profileIndex, trajectory);
+            if (!trajectory.IsClear)
+                ++blockedCount;
+        }
+    }
+
+    if (blockedCount > 0)
+        UE_LOG(LogSoftDesignTraining, Warning, TEXT("%d jump arcs hit the level geometry."), blockedCount);
+}
+
+/*
+ * Samples the jump curve along the link. Blocked arcs are retried with a higher apex, the last try is kept if none is clear.
+ */
+void USDTJumpTable::BakeTrajectory(const FVector& start, const FVector& end, int32 profileIndex, FSDTJumpTrajectory& outTrajectory) const
+{
+    const FJumpProfile& profile = m_Profiles[profileIndex];
+    const int32 sampleCount = FMath::Max(2, m_SampleCount);
+    const FVector heading = end - start;
+
+    outTrajectory.Start = start;
+    outTrajectory.End = end;
+    outTrajectory.Heading = FVector(heading.X, heading.Y, 0.f).Rotation();
+    outTrajectory.Samples.SetNumUninitialized(sampleCount);
+
+    for (float apexScale : { 1.f, 1.5f, 2.f })
+    {
+        for (int32 i = 0; i < sampleCount; ++i)
+        {
+            const float progress = i / float(sampleCount - 1);
+            outTrajectory.Samples[i] = start + progress * heading + FVector(0.f, 0.f, profile.ApexHeight * apexScale * profile.Curve->GetFloatValue(progress));
+        }
+
+        outTrajectory.IsClear = IsTrajectoryClear(outTrajectory);
+        if (outTrajectory.IsClear)
+            return;
+    }
+}
+
+bool USDTJumpTable::IsTrajectoryClear(const FSDTJumpTrajectory& trajectory) const
+{
+    // samples are on the ground at both ends of the arc, the capsule is lifted so it only hits what is in the way
+    const FVector capsuleOffset(0.f, 0.f, m_ValidationHalfHeight + 5.f);
+    const FCollisionShape capsule = FCollisionShape::MakeCapsule(m_ValidationRadius, m_ValidationHalfHeight);
+    const FCollisionObjectQueryParams objectQueryParams(ECC_WorldStatic);
+    const FCollisionQueryParams queryParams(SCENE_QUERY_STAT(SDTJumpValidation), false);
+
+    for (int32 i = 0; i + 1 < trajectory.Samples.Num(); ++i)
+    {
+        if (GetWorld()->SweepTestByObjectType(trajectory.Samples[i] + capsuleOffset, trajectory.Samples[i + 1] + capsuleOffset, FQuat::Identity, objectQueryParams, capsule, queryParams))
+            return false;
+    }
+    return true;
+}
+
+/*
+ * Finds the link whose ends match the path points, the links are few so a scan is enough
+ */
+const FSDTJumpTrajectory* USDTJumpTable::FindTrajectory(int32 profileIndex, const FVector& start, const FVector& end) const
+{
+    // profiles registered since the last build are baked on the next tick
+    if (profileIndex < 0 || profileIndex >= m_BakedProfileCount)
+        return nullptr;
+
+    const float toleranceSquared = FMath::Square(m_LinkMatchTolerance);
+    for (int32 linkIndex = 0; linkIndex < m_Links.Num(); ++linkIndex)
+    {
+        if (FVector::DistSquared(m_Links[linkIndex].Key, start) <= toleranceSquared && FVector::DistSquared(m_Links[linkIndex].Value, end) <= toleranceSquared)
+        {
+            return &m_Trajectories[linkIndex * m_BakedProfileCount + profileIndex];
+        }
+    }
+    return nullptr;
+}
@@ -0,0 +1,91 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "SDTJumpTable.generated.h"
+
+class ANavigationData;
+class UCurveFloat;
+
+/**
+ * Jump arc baked for one nav link and one jump profile, in world space relative to the link start
+ */
+struct FSDTJumpTrajectory
+{
+    FVector Start = FVector::ZeroVector;
+    FVector End = FVector::ZeroVector;
+    FRotator Heading = FRotator::ZeroRotator;
+
+    // Evenly spaced in time, first sample at the link start
+    TArray<FVector> Samples;
+
+    // False if no tested apex height clears the level geometry
+    bool IsClear = false;
+
+    FVector GetLocation(float progress) const;
+};
+
+/**
+ * Jump arcs of all the jump nav links, baked when the navmesh is built.
+ * A jump profile is a jump curve and apex height used by AI controllers. Each link gets one sampled arc per profile,
+ * validated with capsule sweeps against the level geometry (the apex is raised when the arc is blocked). The path
+ * following component then plays the jump back from the samples.
+ */
+UCLASS(config = Game)
+class SOFTDESIGNTRAINING_API USDTJumpTable : public UWorldSubsystem
+{
+    GENERATED_BODY()
+
+public:
+    // Returns the index of the profile, the arcs of new profiles are baked on the next tick
+    int32 RegisterJumpProfile(UCurveFloat* jumpCurve, float apexHeight);
+
+    void Build();
+
+    // Arc of the jump link between the two path points, null if none was baked
+    const FSDTJumpTrajectory* FindTrajectory(int32 profileIndex, const FVector& start, const FVector& end) const;
+
+    // Number of samples of an arc
+    UPROPERTY(config)
+    int32 m_SampleCount = 32;
+
+    // Capsule swept along the arcs to validate them
+    UPROPERTY(config)
+    float m_ValidationRadius = 40.f;
+
+    UPROPERTY(config)
+    float m_ValidationHalfHeight = 90.f;
+
+    // Maximum distance between a path point and the end of a link for the link to match
+    UPROPERTY(config)
+    float m_LinkMatchTolerance = 100.f;
+
+private:
+    void BakeTrajectory(const FVector& start, const FVector& end, int32 profileIndex, FSDTJumpTrajectory& outTrajectory) const;
+    bool IsTrajectoryClear(const FSDTJumpTrajectory& trajectory) const;
+    void RequestBuild();
+
+    UFUNCTION()
+    void OnNavigationGenerationFinished(ANavigationData* navData);
+
+    struct FJumpProfile
+    {
+        UCurveFloat* Curve;
+        float ApexHeight;
+    };
+    TArray<FJumpProfile> m_Profiles;
+
+    UPROPERTY()
+    TArray<UCurveFloat*> m_ProfileCurves;
+
+    // Link start and end, one entry per direction of the links
+    TArray<TPair<FVector, FVector>> m_Links;
+
+    // Arcs indexed by linkIndex * profileCount + profileIndex
+    TArray<FSDTJumpTrajectory> m_Trajectories;
+    int32 m_BakedProfileCount = 0;
+
+    bool m_BuildRequested = false;
+};
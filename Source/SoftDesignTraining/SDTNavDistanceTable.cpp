@@ -0,0 +1,204 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "SDTNavDistanceTable.h"
+#include "SoftDesignTraining.h"
+#include "NavigationSystem.h"
+#include "NavigationData.h"
+
+/*
+ * Gives the point of interest a column, reusing a freed one when possible, and queues the queries of that column only
+ */
+void USDTNavDistanceTable::RegisterPointOfInterest(const AActor* pointOfInterest)
+{
+    if (!pointOfInterest || m_PointOfInterestIndices.Contains(pointOfInterest))
+        return;
+
+    int32 column = INDEX_NONE;
+    if (m_FreeColumns.Num() > 0)
+    {
+        column = m_FreeColumns.Pop(false);
+    }
+    else
+    {
+        column = m_ColumnLocations.AddUninitialized();
+        m_ColumnSerials.Add(0);
+        m_Distances.AddUninitialized(m_Anchors.GetCellCount());
+    }
+
+    m_PointOfInterestIndices.Add(pointOfInterest, column);
+    m_ColumnLocations[column] = pointOfInterest->GetActorLocation();
+    QueueColumn(column);
+}
+
+void USDTNavDistanceTable::UnregisterPointOfInterest(const AActor* pointOfInterest)
+{
+    int32 column = INDEX_NONE;
+    if (!m_PointOfInterestIndices.RemoveAndCopyValue(pointOfInterest, column))
+        return;
+
+    // its queued and running queries are dropped
+    ++m_ColumnSerials[column];
+    m_FreeColumns.Add(column);
+}
+
+int32 USDTNavDistanceTable::GetPointOfInterestIndex(const AActor* pointOfInterest) const
+{
+    const int32* index = m_PointOfInterestIndices.Find(pointOfInterest);
+    return index ? *index : INDEX_NONE;
+}
+
+float USDTNavDistanceTable::GetDistance(const FVector& location, int32 anchor, int32 pointOfInterestIndex) const
+{
+    if (anchor == INDEX_NONE || pointOfInterestIndex == INDEX_NONE)
+        return -1.f;
+
+    const float anchorDistance = m_Distances[pointOfInterestIndex * m_Anchors.GetCellCount() + anchor];
+    if (anchorDistance < 0.f || anchorDistance == MAX_FLT)
+        return anchorDistance;
+
+    return FVector::Dist(location, m_Anchors.GetCellLocation(anchor)) + anchorDistance;
+}
+
+float USDTNavDistanceTable::GetDistance(const FVector& location, const AActor* pointOfInterest) const
+{
+    return GetDistance(location, FindAnchor(location), GetPointOfInterestIndex(pointOfInterest));
+}
+
+bool USDTNavDistanceTable::IsTickable() const
+{
+    const UWorld* world = GetWorld();
+    return !HasAnyFlags(RF_ClassDefaultObject) && world && world->IsGameWorld();
+}
+
+TStatId USDTNavDistanceTable::GetStatId() const
+{
+    RETURN_QUICK_DECLARE_CYCLE_STAT(USDTNavDistanceTable, STATGROUP_Tickables);
+}
+
+/*
+ * Lays the anchors again when the navmesh changed, starting over if it changes during the build, then keeps the queued path queries flowing
+ */
+void USDTNavDistanceTable::Tick(float deltaTime)
+{
+    if (m_AnchorsRequested)
+        StartAnchorBuild();
+
+    if (m_AnchorBuildRunning)
+        ContinueAnchorBuild();
+
+    SendQueries();
+}
+
+void USDTNavDistanceTable::OnNavigationGenerationFinished(ANavigationData* navData)
+{
+    m_AnchorsRequested = true;
+}
+
+void USDTNavDistanceTable::StartAnchorBuild()
+{
+    UNavigationSystemV1* navSystem = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld());
+    if (!navSystem)
+        return;
+
+    // rebuild the table whenever the navmesh changes
+    navSystem->OnNavigationGenerationFinishedDelegate.AddUniqueDynamic(this, &USDTNavDistanceTable::OnNavigationGenerationFinished);
+
+    const ANavigationData* navData = navSystem->GetDefaultNavDataInstance(FNavigationSystem::DontCreate);
+    if (!navData || navSystem->IsNavigationBuildInProgress())
+        return;
+
+    m_AnchorsRequested = false;
+    m_PendingAnchors.BeginBuild(navData->GetBounds(), m_AnchorSize, false);
+    m_AnchorBuildRunning = m_PendingAnchors.GetCellCount() > 0;
+}
+
+/*
+ * Projects anchors within the frame budget, on the game thread where the navmesh is not modified under the queries.
+ * The table in use is kept until all the anchors are laid.
+ */
+void USDTNavDistanceTable::ContinueAnchorBuild()
+{
+    const UNavigationSystemV1* navSystem = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld());
+    const ANavigationData* navData = navSystem ? navSystem->GetDefaultNavDataInstance(FNavigationSystem::DontCreate) : nullptr;
+    if (!navData || navSystem->IsNavigationBuildInProgress())
+        return;
+
+    if (m_PendingAnchors.ContinueBuild(*navSystem, *navData, m_AnchorBuildBudgetMs / 1000.0))
+        FinishAnchorBuild();
+}
+
+/*
+ * The distances of the previous anchors are meaningless with the new ones, every column is queried again
+ */
+void USDTNavDistanceTable::FinishAnchorBuild()
+{
+    m_Anchors = MoveTemp(m_PendingAnchors);
+    m_PendingAnchors.Reset();
+    m_AnchorBuildRunning = false;
+
+    m_Distances.SetNumUninitialized(m_ColumnLocations.Num() * m_Anchors.GetCellCount());
+    m_QueuedQueries.Reset();
+    m_NextQuery = 0;
+    for (const TPair<const AActor*, int32>& pointOfInterest : m_PointOfInterestIndices)
+    {
+        QueueColumn(pointOfInterest.Value);
+    }
+
+    UE_LOG(LogSoftDesignTraining, Log, TEXT("Navmesh distance table anchors built: %d anchors, %d points of interest"), m_Anchors.GetCellCount(), m_PointOfInterestIndices.Num());
+}
+
+/*
+ * Marks the column unknown and queues a query from each walkable anchor, nothing is queued until the anchors are built
+ */
+void USDTNavDistanceTable::QueueColumn(int32 column)
+{
+    const uint32 serial = ++m_ColumnSerials[column];
+    const int32 anchorCount = m_Anchors.GetCellCount();
+    for (int32 anchor = 0; anchor < anchorCount; ++anchor)
+    {
+        m_Distances[column * anchorCount + anchor] = -1.f;
+        if (m_Anchors.IsWalkable(anchor))
+            m_QueuedQueries.Add({ column, anchor, serial });
+    }
+}
+
+void USDTNavDistanceTable::SendQueries()
+{
+    if (m_NextQuery >= m_QueuedQueries.Num())
+        return;
+
+    UNavigationSystemV1* navSystem = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld());
+    const ANavigationData* navData = navSystem ? navSystem->GetDefaultNavDataInstance(FNavigationSystem::DontCreate) : nullptr;
+    if (!navData)
+        return;
+
+    const int32 maxQueriesInFlight = FMath::Max(1, m_MaxQueriesInFlight);
+    while (m_NextQuery < m_QueuedQueries.Num() && m_PendingQueries < maxQueriesInFlight)
+    {
+        const FQuery& query = m_QueuedQueries[m_NextQuery++];
+        if (query.Serial != m_ColumnSerials[query.Column])
+            continue;
+
+        FPathFindingQuery pathQuery(this, *navData, m_Anchors.GetCellLocation(query.Anchor), m_ColumnLocations[query.Column], navData->GetDefaultQueryFilter());
+        ++m_PendingQueries;
+        navSystem->FindPathAsync(navData->GetConfig(), pathQuery, FNavPathQueryDelegate::CreateUObject(this, &USDTNavDistanceTable::OnPathFound, query.Column, query.Anchor, query.Serial));
+    }
+
+    if (m_NextQuery >= m_QueuedQueries.Num())
+    {
+        m_QueuedQueries.Reset();
+        m_NextQuery = 0;
+    }
+}
+
+void USDTNavDistanceTable::OnPathFound(uint32 queryId, ENavigationQueryResult::Type result, FNavPathSharedPtr path, int32 column, int32 anchor, uint32 serial)
+{
+    --m_PendingQueries;
+
+    // the column was freed or queried again, or the anchors were replaced
+    if (serial != m_ColumnSerials[column])
+        return;
+
+    const bool reachable = result == ENavigationQueryResult::Success && path.IsValid() && path->IsValid() && !path->IsPartial();
+    m_Distances[column * m_Anchors.GetCellCount() + anchor] = reachable ? path->GetLength() : MAX_FLT;
+}
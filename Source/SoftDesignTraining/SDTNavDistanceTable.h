@@ -0,0 +1,99 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Tickable.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "NavigationSystemTypes.h"
+#include "SDTNavGrid.h"
+#include "SDTNavDistanceTable.generated.h"
+
+class ANavigationData;
+
+/**
+ * Navmesh distances from a coarse grid of anchors to every point of interest (collectibles and flee locations).
+ * The distance from any location to a point of interest is estimated as the distance to the nearest anchor plus the table entry,
+ * which replaces a path query wherever an estimate is enough to rank candidates.
+ * Each registered point of interest owns a column of the table, filled by asynchronous path queries spread over several frames:
+ * registering a point of interest only queries its column, unregistering it frees the column for the next one.
+ * The anchors are laid over the navmesh a few per frame whenever the navmesh changes, then all the columns are queried again.
+ * The entries stay unknown until their query completes.
+ */
+UCLASS(config = Game)
+class SOFTDESIGNTRAINING_API USDTNavDistanceTable : public UWorldSubsystem, public FTickableGameObject
+{
+    GENERATED_BODY()
+
+public:
+    void RegisterPointOfInterest(const AActor* pointOfInterest);
+    void UnregisterPointOfInterest(const AActor* pointOfInterest);
+
+    bool IsBuilt() const { return m_Anchors.IsBuilt(); }
+
+    // Anchor nearest to the location, INDEX_NONE when the location is away from the navmesh
+    int32 FindAnchor(const FVector& location) const { return m_Anchors.FindNearestWalkableCell(location); }
+    int32 GetPointOfInterestIndex(const AActor* pointOfInterest) const;
+
+    // Estimated navmesh distance from the location, whose anchor is given, to the point of interest.
+    // Negative if unknown (location away from the navmesh, point of interest not queried yet), MAX_FLT if unreachable.
+    float GetDistance(const FVector& location, int32 anchor, int32 pointOfInterestIndex) const;
+    float GetDistance(const FVector& location, const AActor* pointOfInterest) const;
+
+    virtual void Tick(float deltaTime) override;
+    virtual bool IsTickable() const override;
+    virtual TStatId GetStatId() const override;
+    virtual UWorld* GetTickableGameObjectWorld() const override { return GetWorld(); }
+
+    // Size of the cell of an anchor, in world units
+    UPROPERTY(config)
+    float m_AnchorSize = 500.f;
+
+    // Maximum number of path queries running at the same time
+    UPROPERTY(config)
+    int32 m_MaxQueriesInFlight = 64;
+
+    // Game thread time spent laying the anchors over the navmesh each frame, in milliseconds
+    UPROPERTY(config)
+    float m_AnchorBuildBudgetMs = 1.f;
+
+private:
+    void StartAnchorBuild();
+    void ContinueAnchorBuild();
+    void FinishAnchorBuild();
+    void QueueColumn(int32 column);
+    void SendQueries();
+    void OnPathFound(uint32 queryId, ENavigationQueryResult::Type result, FNavPathSharedPtr path, int32 column, int32 anchor, uint32 serial);
+
+    UFUNCTION()
+    void OnNavigationGenerationFinished(ANavigationData* navData);
+
+    FSDTNavGrid m_Anchors;
+
+    // Column of each registered point of interest, and the location its column is queried with
+    TMap<const AActor*, int32> m_PointOfInterestIndices;
+    TArray<FVector> m_ColumnLocations;
+    TArray<int32> m_FreeColumns;
+
+    // Incremented whenever a column is freed or queried again, the results of the previous queries of the column are dropped
+    TArray<uint32> m_ColumnSerials;
+
+    // Distances indexed by column * anchor count + anchor, negative when unknown and MAX_FLT when unreachable
+    TArray<float> m_Distances;
+
+    // Path queries waiting to be sent, in order
+    struct FQuery
+    {
+        int32 Column;
+        int32 Anchor;
+        uint32 Serial;
+    };
+    TArray<FQuery> m_QueuedQueries;
+    int32 m_NextQuery = 0;
+    int32 m_PendingQueries = 0;
+
+    // Anchors being laid, replacing the ones in use once complete
+    FSDTNavGrid m_PendingAnchors;
+    bool m_AnchorBuildRunning = false;
+    bool m_AnchorsRequested = true;
+};
@@ -0,0 +1,245 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "SDTNavGrid.h"
+#include "SoftDesignTraining.h"
+#include "NavigationSystem.h"
+#include "NavigationData.h"
+
+namespace
+{
+    // Neighbor directions, a direction and its opposite are 4 apart
+    const FIntPoint NeighborOffsets[8] = { {1, 0}, {1, 1}, {0, 1}, {-1, 1}, {-1, 0}, {-1, -1}, {0, -1}, {1, -1} };
+}
+
+void FSDTNavGrid::Build(const UNavigationSystemV1& navSystem, const ANavigationData& navData, const FBox& bounds, float cellSize)
+{
+    BeginBuild(bounds, cellSize, false);
+    ContinueBuild(navSystem, navData, MAX_dbl);
+}
+
+void FSDTNavGrid::BeginBuild(const FBox& bounds, float cellSize, bool withLinks)
+{
+    Reset();
+
+    if (!bounds.IsValid || cellSize <= 0.f)
+        return;
+
+    m_CellSize = cellSize;
+    m_Origin = FVector2D(bounds.Min);
+    m_CellCount.X = FMath::Max(1, FMath::CeilToInt((bounds.Max.X - bounds.Min.X) / cellSize));
+    m_CellCount.Y = FMath::Max(1, FMath::CeilToInt((bounds.Max.Y - bounds.Min.Y) / cellSize));
+
+    const int32 cellCount = m_CellCount.X * m_CellCount.Y;
+    m_CellLocations.SetNumUninitialized(cellCount);
+    m_Walkable.Init(false, cellCount);
+
+    // each cell center is projected on the navmesh, searching through the whole cell and the whole height of the bounds
+    m_ProjectionExtent = FVector(cellSize * 0.5f, cellSize * 0.5f, bounds.GetExtent().Z + 100.f);
+    m_CenterZ = bounds.GetCenter().Z;
+    m_NextProjectedCell = 0;
+
+    // the links are tested once all the cells are projected
+    if (withLinks)
+        m_Links.Init(0, cellCount);
+    m_NextLinkedCell = withLinks ? 0 : cellCount;
+}
+
+bool FSDTNavGrid::ContinueBuild(const UNavigationSystemV1& navSystem, const ANavigationData& navData, double timeBudget)
+{
+    const double endTime = FPlatformTime::Seconds() + timeBudget;
+    const int32 cellCount = GetCellCount();
+
+    while (m_NextProjectedCell < cellCount)
+    {
+        ProjectCell(navSystem, navData, m_NextProjectedCell++);
+        if (FPlatformTime::Seconds() >= endTime)
+            return IsBuilt();
+    }
+
+    while (m_NextLinkedCell < cellCount)
+    {
+        LinkCell(navData, m_NextLinkedCell++);
+        if (FPlatformTime::Seconds() >= endTime)
+            return IsBuilt();
+    }
+    return IsBuilt();
+}
+
+void FSDTNavGrid::ProjectCell(const UNavigationSystemV1& navSystem, const ANavigationData& navData, int32 cellIndex)
+{
+    const FIntPoint coord = GetCellCoord(cellIndex);
+    const FVector cellCenter(m_Origin.X + (coord.X + 0.5f) * m_CellSize, m_Origin.Y + (coord.Y + 0.5f) * m_CellSize, m_CenterZ);
+
+    FNavLocation navLocation;
+    if (navSystem.ProjectPointToNavigation(cellCenter, navLocation, m_ProjectionExtent, &navData))
+    {
+        m_CellLocations[cellIndex] = navLocation.Location;
+        m_Walkable[cellIndex] = true;
+    }
+    else
+    {
+        m_CellLocations[cellIndex] = cellCenter;
+    }
+}
+
+void FSDTNavGrid::Reset()
+{
+    m_CellCount = FIntPoint::ZeroValue;
+    m_CellLocations.Reset();
+    m_Walkable.Reset();
+    m_Links.Reset();
+    m_NextProjectedCell = 0;
+    m_NextLinkedCell = 0;
+}
+
+/*
+ * Links each walkable cell to its 8 neighbors, at once on a built grid
+ */
+void FSDTNavGrid::BuildLinks(const ANavigationData& navData)
+{
+    const int32 cellCount = GetCellCount();
+    m_Links.Init(0, cellCount);
+
+    for (int32 cellIndex = 0; cellIndex < cellCount; ++cellIndex)
+    {
+        LinkCell(navData, cellIndex);
+    }
+    m_NextLinkedCell = cellCount;
+}
+
+/*
+ * Only half of the directions are raycast, the other half is the same link seen from the neighbor
+ */
+void FSDTNavGrid::LinkCell(const ANavigationData& navData, int32 cellIndex)
+{
+    if (!m_Walkable[cellIndex])
+        return;
+
+    FSharedConstNavQueryFilter queryFilter = navData.GetDefaultQueryFilter();
+    const FIntPoint coord = GetCellCoord(cellIndex);
+    for (int32 direction = 0; direction < 4; ++direction)
+    {
+        const int32 neighborIndex = GetCellIndex(coord + NeighborOffsets[direction]);
+        if (neighborIndex == INDEX_NONE || !m_Walkable[neighborIndex])
+            continue;
+
+        FVector hitLocation;
+        if (navData.Raycast(m_CellLocations[cellIndex], m_CellLocations[neighborIndex], hitLocation, queryFilter))
+            continue;
+
+        m_Links[cellIndex] |= 1 << direction;
+        m_Links[neighborIndex] |= 1 << (direction + 4);
+    }
+}
+
+int32 FSDTNavGrid::GetLinkedNeighbors(int32 cellIndex, int32 outNeighbors[8]) const
+{
+    const uint8 links = m_Links[cellIndex];
+    const FIntPoint coord = GetCellCoord(cellIndex);
+
+    int32 neighborCount = 0;
+    for (int32 direction = 0; direction < 8; ++direction)
+    {
+        if (links & (1 << direction))
+            outNeighbors[neighborCount++] = GetCellIndex(coord + NeighborOffsets[direction]);
+    }
+    return neighborCount;
+}
+
+void FSDTNavGrid::ComputeDistances(const TArray<int32>& sourceCells, TArray<float>& outDistances) const
+{
+    outDistances.Init(MAX_FLT, GetCellCount());
+    if (!HasLinks())
+        return;
+
+    struct FOpenCell
+    {
+        float Distance;
+        int32 CellIndex;
+    };
+    auto isCloser = [](const FOpenCell& cell1, const FOpenCell& cell2) { return cell1.Distance < cell2.Distance; };
+
+    TArray<FOpenCell> openCells;
+    for (int32 sourceCell : sourceCells)
+    {
+        if (sourceCell == INDEX_NONE || !m_Walkable[sourceCell])
+            continue;
+
+        outDistances[sourceCell] = 0.f;
+        openCells.HeapPush({ 0.f, sourceCell }, isCloser);
+    }
+
+    int32 neighbors[8];
+    while (openCells.Num() > 0)
+    {
+        FOpenCell openCell;
+        openCells.HeapPop(openCell, isCloser, false);
+
+        // the cell was reached by a shorter route after being pushed
+        if (openCell.Distance > outDistances[openCell.CellIndex])
+            continue;
+
+        const int32 neighborCount = GetLinkedNeighbors(openCell.CellIndex, neighbors);
+        for (int32 i = 0; i < neighborCount; ++i)
+        {
+            const int32 neighborIndex = neighbors[i];
+            const float distance = openCell.Distance + FVector::Dist(m_CellLocations[openCell.CellIndex], m_CellLocations[neighborIndex]);
+            if (distance < outDistances[neighborIndex])
+            {
+                outDistances[neighborIndex] = distance;
+                openCells.HeapPush({ distance, neighborIndex }, isCloser);
+            }
+        }
+    }
+}
+
+int32 FSDTNavGrid::GetCellIndex(const FVector& location) const
+{
+    return GetCellIndex(FIntPoint(FMath::FloorToInt((location.X - m_Origin.X) / m_CellSize), FMath::FloorToInt((location.Y - m_Origin.Y) / m_CellSize)));
+}
+
+int32 FSDTNavGrid::GetCellIndex(const FIntPoint& coord) const
+{
+    if (coord.X < 0 || coord.Y < 0 || coord.X >= m_CellCount.X || coord.Y >= m_CellCount.Y)
+        return INDEX_NONE;
+
+    return coord.Y * m_CellCount.X + coord.X;
+}
+
+int32 FSDTNavGrid::FindNearestWalkableCell(const FVector& location, int32 maxRing) const
+{
+    if (!IsBuilt())
+        return INDEX_NONE;
+
+    // clamp the location in the grid so pawns slightly outside of the bounds still get a cell
+    const FIntPoint coord(
+        FMath::Clamp(FMath::FloorToInt((location.X - m_Origin.X) / m_CellSize), 0, m_CellCount.X - 1),
+        FMath::Clamp(FMath::FloorToInt((location.Y - m_Origin.Y) / m_CellSize), 0, m_CellCount.Y - 1));
+
+    int32 bestCell = INDEX_NONE;
+    float bestDistSquared = MAX_FLT;
+
+    for (int32 ring = 0; ring <= maxRing && bestCell == INDEX_NONE; ++ring)
+    {
+        for (int32 y = -ring; y <= ring; ++y)
+        {
+            for (int32 x = -ring; x <= ring; ++x)
+            {
+                if (FMath::Max(FMath::Abs(x), FMath::Abs(y)) != ring)
+                    continue;
+
+                const int32 cellIndex = GetCellIndex(FIntPoint(coord.X + x, coord.Y + y));
+                if (cellIndex == INDEX_NONE || !m_Walkable[cellIndex])
+                    continue;
+
+                const float distSquared = FVector::DistSquared(location, m_CellLocations[cellIndex]);
+                if (distSquared < bestDistSquared)
+                {
+                    bestCell = cellIndex;
+                    bestDistSquared = distSquared;
+                }
+            }
+        }
+    }
+    return bestCell;
+}
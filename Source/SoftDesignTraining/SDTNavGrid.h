@@ -0,0 +1,75 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class ANavigationData;
+class UNavigationSystemV1;
+
+/**
+ * Regular 2D grid laid over the navigable bounds of a level.
+ * Each cell center is projected on the navmesh once, cells without navmesh are flagged as not walkable.
+ * Optionally, neighboring cells are linked when the navmesh joins them in a straight line, making the grid a graph
+ * on which distance fields can be computed.
+ * The navmesh queries run on the game thread. Large grids are built a few cells per frame with BeginBuild and ContinueBuild.
+ */
+class SOFTDESIGNTRAINING_API FSDTNavGrid
+{
+public:
+    void Build(const UNavigationSystemV1& navSystem, const ANavigationData& navData, const FBox& bounds, float cellSize);
+    void Reset();
+
+    // Time-sliced build: BeginBuild lays out the cells, then each ContinueBuild projects, and links when asked, cells until the time budget is spent.
+    // ContinueBuild returns true once the grid is built. The navmesh must not change in between, restart the build when it does.
+    void BeginBuild(const FBox& bounds, float cellSize, bool withLinks);
+    bool ContinueBuild(const UNavigationSystemV1& navSystem, const ANavigationData& navData, double timeBudget);
+
+    bool IsBuilt() const { return m_CellLocations.Num() > 0 && m_NextProjectedCell >= m_CellLocations.Num() && m_NextLinkedCell >= m_CellLocations.Num(); }
+    int32 GetCellCount() const { return m_CellLocations.Num(); }
+    float GetCellSize() const { return m_CellSize; }
+    const FVector2D& GetOrigin() const { return m_Origin; }
+    const FIntPoint& GetGridSize() const { return m_CellCount; }
+
+    int32 GetCellIndex(const FVector& location) const;
+    int32 GetCellIndex(const FIntPoint& coord) const;
+    FIntPoint GetCellCoord(int32 cellIndex) const { return FIntPoint(cellIndex % m_CellCount.X, cellIndex / m_CellCount.X); }
+
+    // Returns the walkable cell nearest to the location, searching up to maxRing cells around it
+    int32 FindNearestWalkableCell(const FVector& location, int32 maxRing = 2) const;
+
+    bool IsWalkable(int32 cellIndex) const { return m_Walkable[cellIndex]; }
+    const FVector& GetCellLocation(int32 cellIndex) const { return m_CellLocations[cellIndex]; }
+
+    // Links each walkable cell to its 8 neighbors, tested with navmesh raycasts
+    void BuildLinks(const ANavigationData& navData);
+    bool HasLinks() const { return m_Links.Num() > 0; }
+
+    // Fills the linked neighbors of the cell, returns their count
+    int32 GetLinkedNeighbors(int32 cellIndex, int32 outNeighbors[8]) const;
+
+    // Distance through the links from every cell to the nearest source cell (Dijkstra), MAX_FLT for the unreachable cells.
+    // Can run on any thread as long as the grid is not modified.
+    void ComputeDistances(const TArray<int32>& sourceCells, TArray<float>& outDistances) const;
+
+private:
+    void ProjectCell(const UNavigationSystemV1& navSystem, const ANavigationData& navData, int32 cellIndex);
+    void LinkCell(const ANavigationData& navData, int32 cellIndex);
+
+    FVector2D m_Origin = FVector2D::ZeroVector;
+    float m_CellSize = 0.f;
+    FIntPoint m_CellCount = FIntPoint::ZeroValue;
+
+    // Cell centers, projected on the navmesh when walkable
+    TArray<FVector> m_CellLocations;
+    TBitArray<> m_Walkable;
+
+    // One bit per direction, see the direction offsets in the implementation
+    TArray<uint8> m_Links;
+
+    // Progress of the build
+    FVector m_ProjectionExtent = FVector::ZeroVector;
+    float m_CenterZ = 0.f;
+    int32 m_NextProjectedCell = 0;
+    int32 m_NextLinkedCell = 0;
+};
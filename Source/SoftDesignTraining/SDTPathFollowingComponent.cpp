@@ -5,81 +5,259 @@
 #include "SoftDesignTraining.h"
 #include "SDTUtils.h"
 #include "SDTAIController.h"
+#include "SDTAvoidanceSubsystem.h"
+#include "SDTBenchmark.h"
+#include "SDTHazardSubsystem.h"
+#include "SDTJumpTable.h"
+#include "SDTStats.h"
 #include "GameFramework/CharacterMovementComponent.h"
 
 #include "DrawDebugHelpers.h"
 
+static TAutoConsoleVariable<int32> CVarHazardAvoidance(
+    TEXT("sdt.HazardAvoidance"),
+    1,
+    TEXT("Makes the AI pawns wait before path segments crossed by projectiles.\n")
+    TEXT(" 0: off\n")
+    TEXT(" 1: on"),
+    ECVF_Default);
+
+static TAutoConsoleVariable<int32> CVarAvoidance(
+    TEXT("sdt.Avoidance"),
+    1,
+    TEXT("Local avoidance between the AI pawns.\n")
+    TEXT(" 0: off, pawns follow their path straight\n")
+    TEXT(" 1: on"),
+    ECVF_Default);
+
 USDTPathFollowingComponent::USDTPathFollowingComponent(const FObjectInitializer& ObjectInitializer)
 {}
 
+void USDTPathFollowingComponent::BeginPlay()
+{
+    Super::BeginPlay();
+
+    m_Controller = Cast<ASDTAIController>(GetOwner());
+
+    if (USDTAvoidanceSubsystem* avoidance = GetWorld()->GetSubsystem<USDTAvoidanceSubsystem>())
+        avoidance->RegisterAgent(this);
+}
+
+void USDTPathFollowingComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+    if (USDTAvoidanceSubsystem* avoidance = GetWorld()->GetSubsystem<USDTAvoidanceSubsystem>())
+        avoidance->UnregisterAgent(this);
+
+    Super::EndPlay(EndPlayReason);
+}
+
 void USDTPathFollowingComponent::FollowPathSegment(float DeltaTime)
 {
-    const TArray<FNavPathPoint>& points = Path->GetPathPoints();
-    const FNavPathPoint& segmentStart = points[MoveSegmentStartIndex];
+    SDT_BENCHMARK_SCOPE(FollowPathSegment);
+    SDT_SCOPE_CYCLE_STAT(FollowPathSegment);
 
-    if (SDTUtils::HasJumpFlag(segmentStart)) // Update jump
+    if (m_Jumping)
+    {
+        m_PreferredVelocity = FVector::ZeroVector;
+        UpdateJump(DeltaTime);
+    }
+    else if (GetWorld()->GetTimeSeconds() >= m_HazardWaitEndTime)
     {
-        ASDTAIController* controller = Cast<ASDTAIController>(GetOwner());
-        const float progress = controller->m_jumpTime / controller->m_jumpDuration;
-        controller->m_jumpProgress = progress;
-
-        if (MoveSegmentStartIndex + 1 < points.Num())
-        {
-            const FNavPathPoint& segmentEnd = points[MoveSegmentStartIndex + 1];
-
-            // Compute the targeted height and heading
-            float curveValue = Cast<ASDTAIController>(GetOwner())->JumpCurve->GetFloatValue(progress);
-            FVector heading = (segmentEnd.Location - segmentStart.Location);
-
-            controller->m_jumpTime += DeltaTime;
-
-            // Teleport to the next location
-            controller->GetPawn()->SetActorLocation(FVector(
-                controller->m_jumpStartingPos.X + progress * heading.X,
-                controller->m_jumpStartingPos.Y + progress * heading.Y,
-                controller->m_jumpStartingPos.Z + controller->JumpApexHeight * curveValue));
-        }
+        FollowPathSegmentWithAvoidance(DeltaTime);
     }
     else
     {
-		Super::FollowPathSegment(DeltaTime);
+        // standing still on purpose, not blocked
+        m_PreferredVelocity = FVector::ZeroVector;
+        ResetBlockDetectionData();
+    }
+}
+
+/*
+ * Heads to the current path point at full speed, bent by the avoidance velocity computed from the previous frame.
+ * Like Super, the speed is clamped so the pawn does not overshoot the path point within the frame.
+ */
+void USDTPathFollowingComponent::FollowPathSegmentWithAvoidance(float deltaTime)
+{
+    USDTAvoidanceSubsystem* avoidance = GetWorld()->GetSubsystem<USDTAvoidanceSubsystem>();
+    if (CVarAvoidance.GetValueOnGameThread() == 0 || !avoidance || !MovementComp)
+    {
+        m_PreferredVelocity = FVector::ZeroVector;
+        Super::FollowPathSegment(deltaTime);
+        return;
     }
+
+    const FVector toTarget = GetCurrentTargetLocation() - MovementComp->GetActorFeetLocation();
+    const float arrivalSpeed = deltaTime > 0.f ? toTarget.Size2D() / deltaTime : MovementComp->GetMaxSpeed();
+    m_PreferredVelocity = toTarget.GetSafeNormal2D() * FMath::Min(MovementComp->GetMaxSpeed(), arrivalSpeed);
+
+    const FVector velocity = m_HasAvoidanceVelocity ? m_AvoidanceVelocity : m_PreferredVelocity;
+    m_HasAvoidanceVelocity = false;
+
+    const bool notFollowingLastSegment = MoveSegmentEndIndex < Path->GetPathPoints().Num() - 1;
+    MovementComp->RequestDirectMove(velocity, notFollowingLastSegment);
 }
 
 void USDTPathFollowingComponent::SetMoveSegment(int32 segmentStartIndex)
 {
+    SDT_SCOPE_CYCLE_STAT(SetMoveSegment);
+
     Super::SetMoveSegment(segmentStartIndex);
 
     const TArray<FNavPathPoint>& points = Path->GetPathPoints();
     const FNavPathPoint& segmentStart = points[MoveSegmentStartIndex];
     const FNavPathPoint& segmentEnd = points[MoveSegmentStartIndex + 1];
 
-    ASDTAIController* controller = Cast<ASDTAIController>(GetOwner());
-    APawn* pawn = controller->GetPawn();
+    if (!m_Controller)
+        return;
 
     if (SDTUtils::HasJumpFlag(segmentStart) && FNavMeshNodeFlags(segmentStart.Flags).IsNavLink()) // Handle starting jump
     {
-        // Set the pawn in flying mode
-        Cast<UCharacterMovementComponent>(MovementComp)->SetMovementMode(MOVE_Flying);
+        StartJump(segmentStart, segmentEnd);
+    }
+    else
+    {
+        EndJump();
+
+        // Set the pawn in walking mode
+        Cast<UCharacterMovementComponent>(MovementComp)->SetMovementMode(MOVE_Walking);
+
+        WaitForSafeCrossing(segmentEnd.Location);
+    }
+}
+
+void USDTPathFollowingComponent::OnPathFinished(const FPathFollowingResult& Result)
+{
+    EndJump();
+    m_PreferredVelocity = FVector::ZeroVector;
+    m_HasAvoidanceVelocity = false;
+
+    Super::OnPathFinished(Result);
+}
+
+void USDTPathFollowingComponent::StartJump(const FNavPathPoint& segmentStart, const FNavPathPoint& segmentEnd)
+{
+    SDT_SCOPE_CYCLE_STAT(StartJump);
+
+    APawn* pawn = m_Controller->GetPawn();
+
+    // Set the pawn in flying mode
+    Cast<UCharacterMovementComponent>(MovementComp)->SetMovementMode(MOVE_Flying);
+
+    // Update the controller jump states, the jump start and end anim notifies update InAir and Landing
+    m_Controller->AtJumpSegment = true;
+    m_Controller->Landing = false;
+    m_Controller->m_jumpTime = 0.0f;
+    m_Controller->m_jumpStartingPos = pawn->GetActorLocation();
+
+    FRotator jumpHeading;
+    USDTJumpTable* jumpTable = GetWorld()->GetSubsystem<USDTJumpTable>();
+    const FSDTJumpTrajectory* trajectory = jumpTable ? jumpTable->FindTrajectory(m_Controller->GetJumpProfile(), segmentStart.Location, segmentEnd.Location) : nullptr;
+    m_HasJumpTrajectory = trajectory != nullptr;
+    if (trajectory)
+    {
+        m_JumpTrajectory = *trajectory;
 
-        // Update the controller jump states
-        controller->AtJumpSegment = true;
-        controller->m_jumpTime = 0.0f;
-        controller->m_jumpStartingPos = pawn->GetActorLocation();
+        // the arc is baked from the link start, keep the pawn where it is
+        m_JumpTrajectoryOffset = m_Controller->m_jumpStartingPos - m_JumpTrajectory.Samples[0];
+        jumpHeading = m_JumpTrajectory.Heading;
+    }
+    else
+    {
+        FVector heading = (segmentEnd.Location - segmentStart.Location);
+        heading.Z = 0;
+        jumpHeading = heading.Rotation();
+    }
+
+    // Turn the pawn towards the jump heading
+    pawn->SetActorRotation(jumpHeading);
+
+    // Overlaps are updated once, when landing
+    UPrimitiveComponent* updatedComponent = MovementComp->UpdatedPrimitive;
+    if (updatedComponent && !m_Jumping)
+    {
+        m_OverlapsBeforeJump = updatedComponent->GetGenerateOverlapEvents();
+        updatedComponent->SetGenerateOverlapEvents(false);
+    }
+    m_Jumping = true;
+}
+
+void USDTPathFollowingComponent::UpdateJump(float deltaTime)
+{
+    SDT_SCOPE_CYCLE_STAT(UpdateJump);
+
+    const TArray<FNavPathPoint>& points = Path->GetPathPoints();
+    if (MoveSegmentStartIndex + 1 >= points.Num())
+        return;
 
-        // Find the jump heading
-        FVector jumpHeading = (segmentEnd.Location - segmentStart.Location);
-        jumpHeading.Z = 0;
-        jumpHeading.Normalize();
+    const float progress = m_Controller->m_jumpTime / m_Controller->m_jumpDuration;
+    m_Controller->m_jumpProgress = progress;
+    m_Controller->m_jumpTime += deltaTime;
 
-        // Turn the pawn towards the jump heading
-        pawn->SetActorRotation(UKismetMathLibrary::FindLookAtRotation(FVector::ZeroVector, jumpHeading));
+    FVector location;
+    if (m_HasJumpTrajectory)
+    {
+        location = m_JumpTrajectory.GetLocation(progress) + m_JumpTrajectoryOffset;
     }
     else
     {
-        controller->AtJumpSegment = false;
+        // Compute the targeted height and heading
+        const FVector heading = points[MoveSegmentStartIndex + 1].Location - points[MoveSegmentStartIndex].Location;
+        const float curveValue = m_Controller->JumpCurve->GetFloatValue(progress);
+        location = FVector(
+            m_Controller->m_jumpStartingPos.X + progress * heading.X,
+            m_Controller->m_jumpStartingPos.Y + progress * heading.Y,
+            m_Controller->m_jumpStartingPos.Z + m_Controller->JumpApexHeight * curveValue);
+    }
 
-        // Set the pawn in walking mode
-        Cast<UCharacterMovementComponent>(MovementComp)->SetMovementMode(MOVE_Walking);
+    if (progress >= 1.f)
+        m_Controller->Landing = true;
+
+    // Teleport to the next location, the attached components are moved in one update
+    USceneComponent* updatedComponent = MovementComp->UpdatedComponent;
+    FScopedMovementUpdate scopedMovement(updatedComponent, EScopedUpdate::DeferredUpdates);
+    updatedComponent->SetWorldLocation(location, false, nullptr, ETeleportType::TeleportPhysics);
+}
+
+void USDTPathFollowingComponent::EndJump()
+{
+    if (m_Controller)
+        m_Controller->AtJumpSegment = false;
+
+    if (!m_Jumping)
+        return;
+
+    m_Jumping = false;
+    m_HasJumpTrajectory = false;
+
+    UPrimitiveComponent* updatedComponent = MovementComp ? MovementComp->UpdatedPrimitive : nullptr;
+    if (updatedComponent)
+    {
+        updatedComponent->SetGenerateOverlapEvents(m_OverlapsBeforeJump);
+        updatedComponent->UpdateOverlaps();
     }
 }
+
+/*
+ * Delays the segment until it can be walked without a projectile crossing it, when it is possible within m_MaxHazardWait
+ */
+void USDTPathFollowingComponent::WaitForSafeCrossing(const FVector& segmentEnd)
+{
+    SDT_SCOPE_CYCLE_STAT(WaitForSafeCrossing);
+
+    m_HazardWaitEndTime = 0.f;
+
+    USDTHazardSubsystem* hazards = GetWorld()->GetSubsystem<USDTHazardSubsystem>();
+    if (CVarHazardAvoidance.GetValueOnGameThread() == 0 || !hazards || !MovementComp)
+        return;
+
+    const FVector segmentStart = MovementComp->GetActorFeetLocation();
+    const float speed = FMath::Max(MovementComp->GetMaxSpeed(), 1.f);
+    const float crossingDuration = FVector::Dist(segmentStart, segmentEnd) / speed;
+    const float currentTime = GetWorld()->GetTimeSeconds();
+    const float clearance = MovementComp->GetPawnOwner() ? MovementComp->GetPawnOwner()->GetSimpleCollisionRadius() : 0.f;
+
+    const float crossingTime = hazards->FindSafeCrossingTime(segmentStart, segmentEnd, currentTime, crossingDuration, clearance, m_MaxHazardWait);
+    if (crossingTime > currentTime)
+        m_HazardWaitEndTime = crossingTime;
+}
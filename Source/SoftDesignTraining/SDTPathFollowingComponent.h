@@ -4,8 +4,11 @@
 
 #include "CoreMinimal.h"
 #include "Navigation/PathFollowingComponent.h"
+#include "SDTJumpTable.h"
 #include "SDTPathFollowingComponent.generated.h"
 
+class ASDTAIController;
+
 /**
 *
 */
@@ -15,6 +18,41 @@ class SOFTDESIGNTRAINING_API USDTPathFollowingComponent : public UPathFollowingC
     GENERATED_UCLASS_BODY()
 
 public:
+    virtual void BeginPlay() override;
+    virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
     virtual void FollowPathSegment(float deltaTime) override;
     virtual void SetMoveSegment(int32 segmentStartIndex) override;
-};
\ No newline at end of file
+    virtual void OnPathFinished(const FPathFollowingResult& Result) override;
+
+    // Local avoidance, the preferred velocity is read and the avoidance velocity written by the avoidance subsystem
+    const FVector& GetPreferredVelocity() const { return m_PreferredVelocity; }
+    void SetAvoidanceVelocity(const FVector& velocity) { m_AvoidanceVelocity = velocity; m_HasAvoidanceVelocity = true; }
+    APawn* GetPawnForAvoidance() const { return MovementComp ? MovementComp->GetPawnOwner() : nullptr; }
+
+    // Longest wait for a projectile lane to clear before crossing it anyway, in seconds
+    UPROPERTY(config)
+    float m_MaxHazardWait = 3.f;
+
+protected:
+    void WaitForSafeCrossing(const FVector& segmentEnd);
+    void FollowPathSegmentWithAvoidance(float deltaTime);
+    void StartJump(const FNavPathPoint& segmentStart, const FNavPathPoint& segmentEnd);
+    void UpdateJump(float deltaTime);
+    void EndJump();
+
+    // World time until which the pawn waits before following its segment
+    float m_HazardWaitEndTime = 0.f;
+
+    ASDTAIController* m_Controller = nullptr;
+
+    FVector m_PreferredVelocity = FVector::ZeroVector;
+    FVector m_AvoidanceVelocity = FVector::ZeroVector;
+    bool m_HasAvoidanceVelocity = false;
+
+    // Copy of the baked arc of the current jump, the table may be rebuilt mid-jump
+    FSDTJumpTrajectory m_JumpTrajectory;
+    bool m_HasJumpTrajectory = false;
+    FVector m_JumpTrajectoryOffset = FVector::ZeroVector;
+    bool m_Jumping = false;
+    bool m_OverlapsBeforeJump = true;
+};
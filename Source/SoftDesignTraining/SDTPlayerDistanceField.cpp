@@ -0,0 +1,256 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "SDTPlayerDistanceField.h"
+#include "SoftDesignTraining.h"
+#include "SDTWorldSnapshot.h"
+#include "Async/Async.h"
+#include "NavigationSystem.h"
+#include "NavigationData.h"
+
+void USDTPlayerDistanceField::Deinitialize()
+{
+    // the worker only holds shared copies, but its result must not outlive the subsystem
+    if (m_PendingField.IsValid())
+        m_PendingField.Wait();
+
+    Super::Deinitialize();
+}
+
+void USDTPlayerDistanceField::RequestField()
+{
+    m_LastRequestTime = GetWorld()->GetTimeSeconds();
+}
+
+bool USDTPlayerDistanceField::IsUpToDate(const FField& field, const FVector& playerLocation) const
+{
+    return FVector::DistSquared(field.PlayerLocation, playerLocation) <= FMath::Square(m_RefreshDistance);
+}
+
+bool USDTPlayerDistanceField::GetChaseTarget(const FVector& location, const FVector& playerLocation, FVector& outTarget) const
+{
+    const FFieldPtr field = m_Field;
+    if (!field || !IsUpToDate(*field, playerLocation))
+        return false;
+
+    const FSDTNavGrid& grid = *field->Grid;
+    const int32 startCell = grid.FindNearestWalkableCell(location);
+    if (startCell == INDEX_NONE || field->Distances[startCell] == MAX_FLT)
+        return false;
+
+    const int32 cell = Descend(grid, startCell, [&field](int32 cellIndex) { return field->Distances[cellIndex]; });
+    if (cell == startCell)
+        return false;
+
+    // the player cell is the bottom of the field, aim at the player itself
+    outTarget = field->Distances[cell] == 0.f ? playerLocation : grid.GetCellLocation(cell);
+    return true;
+}
+
+/*
+ * The cells the player cannot reach, or from which no flee location can be reached, are left out of the walk.
+ * The potential alone could step toward the player when a flee location lies behind it, the player distances are the floor of the walk.
+ */
+bool USDTPlayerDistanceField::GetFleeTarget(const FVector& location, const FVector& playerLocation, FVector& outTarget) const
+{
+    const FFieldPtr field = m_Field;
+    if (!field || !field->FleeDistances || field->FleeLocationCount == 0 || !IsUpToDate(*field, playerLocation))
+        return false;
+
+    const FSDTNavGrid& grid = *field->Grid;
+    const int32 startCell = grid.FindNearestWalkableCell(location);
+    if (startCell == INDEX_NONE)
+        return false;
+
+    const TArray<float>& threatDistances = field->Distances;
+    const TArray<float>& fleeDistances = *field->FleeDistances;
+    const float threatWeight = m_ThreatWeight;
+    const int32 cell = Descend(grid, startCell, [&threatDistances, &fleeDistances, threatWeight](int32 cellIndex) {
+        if (threatDistances[cellIndex] == MAX_FLT || fleeDistances[cellIndex] == MAX_FLT)
+            return MAX_FLT;
+        return fleeDistances[cellIndex] - threatWeight * threatDistances[cellIndex];
+    }, &threatDistances);
+    if (cell == startCell)
+        return false;
+
+    outTarget = grid.GetCellLocation(cell);
+    return true;
+}
+
+/*
+ * The walk stops when it changes direction, so the pawn can move to the end cell in a straight line:
+ * every step is a link, which is a navmesh raycast between the cell centers.
+ */
+int32 USDTPlayerDistanceField::Descend(const FSDTNavGrid& grid, int32 startCell, TFunctionRef<float(int32 cellIndex)> potential, const TArray<float>* floor) const
+{
+    const int32 maxStepCount = FMath::Max(1, FMath::CeilToInt(m_LookaheadDistance / grid.GetCellSize()));
+    int32 cell = startCell;
+    float cellPotential = potential(startCell);
+    FIntPoint stepDirection = FIntPoint::ZeroValue;
+    int32 neighbors[8];
+    for (int32 step = 0; step < maxStepCount; ++step)
+    {
+        int32 nextCell = INDEX_NONE;
+        float nextPotential = cellPotential;
+
+        const int32 neighborCount = grid.GetLinkedNeighbors(cell, neighbors);
+        for (int32 i = 0; i < neighborCount; ++i)
+        {
+            if (floor && (*floor)[neighbors[i]] < (*floor)[cell])
+                continue;
+
+            const float neighborPotential = potential(neighbors[i]);
+            if (neighborPotential < nextPotential)
+            {
+                nextCell = neighbors[i];
+                nextPotential = neighborPotential;
+            }
+        }
+
+        if (nextCell == INDEX_NONE)
+            break;
+
+        const FIntPoint direction = grid.GetCellCoord(nextCell) - grid.GetCellCoord(cell);
+        if (step > 0 && direction != stepDirection)
+            break;
+
+        stepDirection = direction;
+        cell = nextCell;
+        cellPotential = nextPotential;
+    }
+    return cell;
+}
+
+bool USDTPlayerDistanceField::IsTickable() const
+{
+    const UWorld* world = GetWorld();
+    return !HasAnyFlags(RF_ClassDefaultObject) && world && world->IsGameWorld();
+}
+
+TStatId USDTPlayerDistanceField::GetStatId() const
+{
+    RETURN_QUICK_DECLARE_CYCLE_STAT(USDTPlayerDistanceField, STATGROUP_Tickables);
+}
+
+/*
+ * Publishes the grid and the field computed by the workers, then starts the next field when the field is requested and the player moved far enough.
+ * The grid is laid as soon as the navmesh is ready, so it is there when the first pawn requests the field.
+ */
+void USDTPlayerDistanceField::Tick(float deltaTime)
+{
+    if (m_GridRequested)
+        StartGridBuild();
+
+    if (m_PendingGrid)
+        ContinueGridBuild();
+
+    if (m_PendingField.IsValid())
+    {
+        if (!m_PendingField.IsReady())
+            return;
+
+        m_Field = m_PendingField.Get();
+        m_PendingField = TFuture<FFieldPtr>();
+    }
+
+    if (GetWorld()->GetTimeSeconds() - m_LastRequestTime > m_RequestDuration)
+        return;
+
+    const USDTWorldSnapshotSubsystem* snapshots = GetWorld()->GetSubsystem<USDTWorldSnapshotSubsystem>();
+    const FSDTWorldSnapshotPtr snapshot = snapshots ? snapshots->GetSnapshot() : FSDTWorldSnapshotPtr();
+    if (!m_Grid || !snapshot || !snapshot->HasPlayer())
+        return;
+
+    if (!m_Field || m_Field->Grid != m_Grid || m_Field->FleeLocationVersion != snapshot->FleeLocationVersion || !IsUpToDate(*m_Field, snapshot->PlayerLocation))
+    {
+        StartField(snapshot->PlayerLocation, snapshot->FleeLocationPositions, snapshot->FleeLocationVersion);
+    }
+}
+
+void USDTPlayerDistanceField::OnNavigationGenerationFinished(ANavigationData* navData)
+{
+    m_GridRequested = true;
+}
+
+/*
+ * Starts laying the grid, or starts over when the navmesh changed during the build. The grid in use is kept until the new one is complete.
+ */
+void USDTPlayerDistanceField::StartGridBuild()
+{
+    UNavigationSystemV1* navSystem = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld());
+    if (!navSystem)
+        return;
+
+    // rebuild the grid whenever the navmesh changes
+    navSystem->OnNavigationGenerationFinishedDelegate.AddUniqueDynamic(this, &USDTPlayerDistanceField::OnNavigationGenerationFinished);
+
+    const ANavigationData* navData = navSystem->GetDefaultNavDataInstance(FNavigationSystem::DontCreate);
+    if (!navData || navSystem->IsNavigationBuildInProgress())
+        return;
+
+    m_GridRequested = false;
+
+    m_PendingGrid = MakeShared<FSDTNavGrid, ESPMode::ThreadSafe>();
+    m_PendingGrid->BeginBuild(navData->GetBounds(), m_CellSize, true);
+    if (m_PendingGrid->GetCellCount() == 0)
+        m_PendingGrid.Reset();
+}
+
+/*
+ * Projects and links the cells of the grid being built within the frame budget, on the game thread where the navmesh is not modified under the queries
+ */
+void USDTPlayerDistanceField::ContinueGridBuild()
+{
+    const UNavigationSystemV1* navSystem = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld());
+    const ANavigationData* navData = navSystem ? navSystem->GetDefaultNavDataInstance(FNavigationSystem::DontCreate) : nullptr;
+    if (!navData || navSystem->IsNavigationBuildInProgress())
+        return;
+
+    if (!m_PendingGrid->ContinueBuild(*navSystem, *navData, m_GridBuildBudgetMs / 1000.0))
+        return;
+
+    // the grid of a field being computed stays alive with it
+    m_Grid = m_PendingGrid;
+    m_PendingGrid.Reset();
+
+    UE_LOG(LogSoftDesignTraining, Log, TEXT("Player distance field grid built: %d x %d cells"), m_Grid->GetGridSize().X, m_Grid->GetGridSize().Y);
+}
+
+void USDTPlayerDistanceField::StartField(const FVector& playerLocation, const TArray<FVector>& fleeLocations, uint32 fleeLocationVersion)
+{
+    const int32 playerCell = m_Grid->FindNearestWalkableCell(playerLocation);
+    if (playerCell == INDEX_NONE)
+        return;
+
+    // the flee field is static, it is only recomputed with the grid or the flee locations
+    FDistancesPtr fleeDistances;
+    TArray<int32> fleeCells;
+    if (m_Field && m_Field->Grid == m_Grid && m_Field->FleeLocationVersion == fleeLocationVersion)
+    {
+        fleeDistances = m_Field->FleeDistances;
+    }
+    else
+    {
+        for (const FVector& fleeLocation : fleeLocations)
+        {
+            fleeCells.Add(m_Grid->FindNearestWalkableCell(fleeLocation));
+        }
+    }
+
+    m_PendingField = Async(EAsyncExecution::ThreadPool, [grid = m_Grid, playerCell, playerLocation, fleeDistances, fleeCells = MoveTemp(fleeCells), fleeLocationCount = fleeLocations.Num(), fleeLocationVersion]() {
+        TSharedPtr<FField, ESPMode::ThreadSafe> field = MakeShared<FField, ESPMode::ThreadSafe>();
+        field->Grid = grid;
+        field->PlayerLocation = playerLocation;
+        grid->ComputeDistances({ playerCell }, field->Distances);
+
+        field->FleeLocationCount = fleeLocationCount;
+        field->FleeLocationVersion = fleeLocationVersion;
+        field->FleeDistances = fleeDistances;
+        if (!field->FleeDistances)
+        {
+            TSharedPtr<TArray<float>, ESPMode::ThreadSafe> newFleeDistances = MakeShared<TArray<float>, ESPMode::ThreadSafe>();
+            grid->ComputeDistances(fleeCells, *newFleeDistances);
+            field->FleeDistances = newFleeDistances;
+        }
+        return FFieldPtr(field);
+    });
+}
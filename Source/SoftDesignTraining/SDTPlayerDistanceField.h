@@ -0,0 +1,109 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Tickable.h"
+#include "Async/Future.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "SDTNavGrid.h"
+#include "SDTPlayerDistanceField.generated.h"
+
+class ANavigationData;
+
+/**
+ * Navmesh distance from the player to every cell of a fine grid, shared by all the pawns chasing or fleeing the player.
+ * The field is a throttled full recompute, not an incremental one: the player is the source of the field, so any move changes
+ * the distance of every cell. A complete Dijkstra pass from the player cell runs on a worker thread, only once the player has
+ * moved more than the refresh distance. Chasing pawns walk down the field instead of each running a path query to the player.
+ * Fleeing pawns walk up the field, pulled toward the flee locations by a second field that only changes with the flee locations.
+ * The grid is laid over the navmesh a few cells per frame at level load and whenever the navmesh changes, the fields are only kept up to date while pawns request them.
+ */
+UCLASS(config = Game)
+class SOFTDESIGNTRAINING_API USDTPlayerDistanceField : public UWorldSubsystem, public FTickableGameObject
+{
+    GENERATED_BODY()
+
+public:
+    virtual void Deinitialize() override;
+
+    // Keeps the field up to date for a little while
+    void RequestField();
+
+    // Location to move straight to in order to get closer to the player: the furthest cell, within the lookahead distance, reached by walking down the field in a straight line.
+    // Returns false when the field does not cover the location, when the location is already in the cell of the player, or when the field was computed
+    // for a player location more than the refresh distance away from the given one. Can be called from any thread.
+    bool GetChaseTarget(const FVector& location, const FVector& playerLocation, FVector& outTarget) const;
+
+    // Location to move straight to in order to flee the player, walking the same way down the flee potential:
+    // the distance to the nearest flee location minus the weighted distance to the player.
+    // The walk only steps to cells at least as far from the player by the field as the current one, so it never gets closer to the player.
+    // Returns false when the field does not cover the location, when no neighboring cell is safer, or when the field is out of date as above. Can be called from any thread.
+    bool GetFleeTarget(const FVector& location, const FVector& playerLocation, FVector& outTarget) const;
+
+    virtual void Tick(float deltaTime) override;
+    virtual bool IsTickable() const override;
+    virtual TStatId GetStatId() const override;
+    virtual UWorld* GetTickableGameObjectWorld() const override { return GetWorld(); }
+
+    // Size of a cell of the field, in world units
+    UPROPERTY(config)
+    float m_CellSize = 100.f;
+
+    // Distance the player has to move before the whole field is recomputed, the field is not used further than this from the player location it was computed for
+    UPROPERTY(config)
+    float m_RefreshDistance = 200.f;
+
+    // Distance the pawns look ahead along the field
+    UPROPERTY(config)
+    float m_LookaheadDistance = 400.f;
+
+    // Weight of the distance to the player against the distance to the flee locations, above 1 so a fleeing pawn favors getting away from the player over reaching a flee location
+    UPROPERTY(config)
+    float m_ThreatWeight = 2.f;
+
+    // Time the field is kept up to date after a request, in seconds
+    UPROPERTY(config)
+    float m_RequestDuration = 1.f;
+
+    // Game thread time spent laying the grid over the navmesh each frame, in milliseconds
+    UPROPERTY(config)
+    float m_GridBuildBudgetMs = 1.f;
+
+private:
+    typedef TSharedPtr<const FSDTNavGrid, ESPMode::ThreadSafe> FGridPtr;
+    typedef TSharedPtr<const TArray<float>, ESPMode::ThreadSafe> FDistancesPtr;
+
+    struct FField
+    {
+        FGridPtr Grid;
+        FVector PlayerLocation;
+        TArray<float> Distances;
+
+        // Distance to the nearest flee location, shared by the following fields until the flee locations change
+        FDistancesPtr FleeDistances;
+        int32 FleeLocationCount = 0;
+        uint32 FleeLocationVersion = 0;
+    };
+    typedef TSharedPtr<const FField, ESPMode::ThreadSafe> FFieldPtr;
+
+    bool IsUpToDate(const FField& field, const FVector& playerLocation) const;
+    void StartGridBuild();
+    void ContinueGridBuild();
+    void StartField(const FVector& playerLocation, const TArray<FVector>& fleeLocations, uint32 fleeLocationVersion);
+
+    // Steepest descent from the start cell, in a straight line and up to the lookahead distance. Cells with a MAX_FLT potential are never entered.
+    // When a floor is given, only the neighbors whose floor value is not lower than the one of the current cell are entered.
+    int32 Descend(const FSDTNavGrid& grid, int32 startCell, TFunctionRef<float(int32 cellIndex)> potential, const TArray<float>* floor = nullptr) const;
+
+    UFUNCTION()
+    void OnNavigationGenerationFinished(ANavigationData* navData);
+
+    FGridPtr m_Grid;
+    TSharedPtr<FSDTNavGrid, ESPMode::ThreadSafe> m_PendingGrid;
+    FFieldPtr m_Field;
+    TFuture<FFieldPtr> m_PendingField;
+
+    float m_LastRequestTime = -MAX_FLT;
+    bool m_GridRequested = true;
+};
@@ -27,9 +27,25 @@ void ASDTProjectile::FireProjectile(const FVector& direction, float speed)
 
     m_Fired = true;
     m_StartingPosition = GetActorLocation();
+
+    SetActorHiddenInGame(false);
+    SetActorEnableCollision(true);
+    SetActorTickEnabled(true);
 }
 
 void ASDTProjectile::ResetProjectile()
 {
     SetActorLocation(m_StartingPosition);
-}
\ No newline at end of file
+}
+
+/*
+ * Parks a pooled projectile until it is fired
+ */
+void ASDTProjectile::DeactivateProjectile()
+{
+    m_Fired = false;
+
+    SetActorHiddenInGame(true);
+    SetActorEnableCollision(false);
+    SetActorTickEnabled(false);
+}
@@ -21,6 +21,7 @@ public:
 
     void FireProjectile(const FVector& direction, float speed);
     void ResetProjectile();
+    void DeactivateProjectile();
 
 protected:
     float m_Speed;
@@ -0,0 +1,360 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "SDTProjectileManager.h"
+#include "SoftDesignTraining.h"
+#include "SDTProjectile.h"
+#include "SoftDesignTrainingCharacter.h"
+#include "Components/CapsuleComponent.h"
+#include "Components/InstancedStaticMeshComponent.h"
+
+/*
+ * Everything a projectile needs is allocated here, during level load, so firing only has to update a slot and an instance
+ */
+void USDTProjectileManager::Prewarm(const AActor* owner, TSubclassOf<ASDTProjectile> projectileClass, int32 projectileCount, const FTransform& transform, TArray<int32>& outProjectileIds)
+{
+    const int32 rendererIndex = FindOrAddRenderer(projectileClass);
+    if (rendererIndex == INDEX_NONE || projectileCount <= 0)
+        return;
+
+    const int32 totalCount = m_Projectiles.Num() + projectileCount;
+    m_Projectiles.Reserve(totalCount);
+    for (FAlignedFloats* floats : { &m_PositionX, &m_PositionY, &m_PositionZ, &m_PreviousPositionX, &m_PreviousPositionY, &m_PreviousPositionZ, &m_VelocityX, &m_VelocityY, &m_VelocityZ })
+    {
+        floats->Reserve(Align(totalCount, 4));
+    }
+
+    FRenderer& renderer = m_Renderers[rendererIndex];
+    renderer.Projectiles.Reserve(renderer.Projectiles.Num() + projectileCount);
+    renderer.InstanceTransforms.Reserve(renderer.InstanceTransforms.Num() + projectileCount);
+    m_RendererComponents[rendererIndex]->PreAllocateInstancesMemory(projectileCount);
+
+    outProjectileIds.Reserve(outProjectileIds.Num() + projectileCount);
+    for (int32 i = 0; i < projectileCount; ++i)
+    {
+        outProjectileIds.Add(AddParkedProjectile(owner, rendererIndex, transform));
+    }
+}
+
+void USDTProjectileManager::FireProjectile(int32 projectileId, const FTransform& transform, const FVector& velocity)
+{
+    if (!m_ProjectileIndices.IsValidIndex(projectileId) || m_ProjectileIndices[projectileId] == INDEX_NONE)
+        return;
+
+    const int32 projectileIndex = m_ProjectileIndices[projectileId];
+    FProjectile& projectile = m_Projectiles[projectileIndex];
+    const FVector location = transform.GetLocation();
+    projectile.StartLocation = location;
+    projectile.Rotation = transform.GetRotation();
+    projectile.Fired = true;
+
+    m_PositionX[projectileIndex] = m_PreviousPositionX[projectileIndex] = location.X;
+    m_PositionY[projectileIndex] = m_PreviousPositionY[projectileIndex] = location.Y;
+    m_PositionZ[projectileIndex] = m_PreviousPositionZ[projectileIndex] = location.Z;
+    m_VelocityX[projectileIndex] = velocity.X;
+    m_VelocityY[projectileIndex] = velocity.Y;
+    m_VelocityZ[projectileIndex] = velocity.Z;
+
+    // the instance is shown by giving it back the scale of the mesh, its location is updated with the others
+    FRenderer& renderer = m_Renderers[projectile.RendererIndex];
+    renderer.InstanceTransforms[projectile.InstanceIndex] = FTransform(projectile.Rotation, location, renderer.Scale);
+}
+
+/*
+ * Parked projectiles do not move, are drawn with a zero scale and are skipped by the hit tests
+ */
+int32 USDTProjectileManager::AddParkedProjectile(const AActor* owner, int32 rendererIndex, const FTransform& transform)
+{
+    const int32 projectileId = m_FreeProjectileIds.Num() > 0 ? m_FreeProjectileIds.Pop(false) : m_ProjectileIndices.Add(INDEX_NONE);
+
+    FRenderer& renderer = m_Renderers[rendererIndex];
+    const FVector location = transform.GetLocation();
+    const int32 projectileIndex = m_Projectiles.Add({ owner, projectileId, location, transform.GetRotation(), renderer.Radius, rendererIndex, renderer.Projectiles.Num(), false });
+    m_ProjectileIndices[projectileId] = projectileIndex;
+
+    // grow the hot arrays by 4 projectiles at a time, padding lanes stay at zero
+    const int32 paddedCount = Align(m_Projectiles.Num(), 4);
+    if (m_PositionX.Num() < paddedCount)
+    {
+        for (FAlignedFloats* floats : { &m_PositionX, &m_PositionY, &m_PositionZ, &m_PreviousPositionX, &m_PreviousPositionY, &m_PreviousPositionZ, &m_VelocityX, &m_VelocityY, &m_VelocityZ })
+        {
+            floats->SetNumZeroed(paddedCount);
+        }
+    }
+
+    m_PositionX[projectileIndex] = m_PreviousPositionX[projectileIndex] = location.X;
+    m_PositionY[projectileIndex] = m_PreviousPositionY[projectileIndex] = location.Y;
+    m_PositionZ[projectileIndex] = m_PreviousPositionZ[projectileIndex] = location.Z;
+
+    renderer.Projectiles.Add(projectileIndex);
+    renderer.InstanceTransforms.Add(FTransform(transform.GetRotation(), location, FVector::ZeroVector));
+    m_RendererComponents[rendererIndex]->AddInstanceWorldSpace(renderer.InstanceTransforms.Last());
+
+    return projectileId;
+}
+
+void USDTProjectileManager::RemoveProjectiles(const AActor* owner)
+{
+    for (int32 projectileIndex = m_Projectiles.Num() - 1; projectileIndex >= 0; --projectileIndex)
+    {
+        if (m_Projectiles[projectileIndex].Owner == owner)
+            RemoveProjectileAt(projectileIndex);
+    }
+}
+
+/*
+ * Swap-removes the projectile: the last projectile and the last instance of its renderer fill the holes
+ */
+void USDTProjectileManager::RemoveProjectileAt(int32 projectileIndex)
+{
+    const FProjectile projectile = m_Projectiles[projectileIndex];
+
+    // instance
+    FRenderer& renderer = m_Renderers[projectile.RendererIndex];
+    UInstancedStaticMeshComponent* component = m_RendererComponents[projectile.RendererIndex];
+    const int32 lastInstanceIndex = renderer.Projectiles.Num() - 1;
+    if (projectile.InstanceIndex != lastInstanceIndex)
+    {
+        const int32 movedProjectileIndex = renderer.Projectiles[lastInstanceIndex];
+        renderer.Projectiles[projectile.InstanceIndex] = movedProjectileIndex;
+        renderer.InstanceTransforms[projectile.InstanceIndex] = renderer.InstanceTransforms[lastInstanceIndex];
+        m_Projectiles[movedProjectileIndex].InstanceIndex = projectile.InstanceIndex;
+        component->UpdateInstanceTransform(projectile.InstanceIndex, renderer.InstanceTransforms[projectile.InstanceIndex], true, true, true);
+    }
+    renderer.Projectiles.RemoveAt(lastInstanceIndex, 1, false);
+    renderer.InstanceTransforms.RemoveAt(lastInstanceIndex, 1, false);
+    component->RemoveInstance(lastInstanceIndex);
+
+    // hot and cold data
+    const int32 lastIndex = m_Projectiles.Num() - 1;
+    if (projectileIndex != lastIndex)
+    {
+        for (FAlignedFloats* floats : { &m_PositionX, &m_PositionY, &m_PositionZ, &m_PreviousPositionX, &m_PreviousPositionY, &m_PreviousPositionZ, &m_VelocityX, &m_VelocityY, &m_VelocityZ })
+        {
+            (*floats)[projectileIndex] = (*floats)[lastIndex];
+        }
+
+        const FProjectile& movedProjectile = m_Projectiles[lastIndex];
+        m_Renderers[movedProjectile.RendererIndex].Projectiles[movedProjectile.InstanceIndex] = projectileIndex;
+        m_ProjectileIndices[movedProjectile.Id] = projectileIndex;
+    }
+    m_Projectiles.RemoveAtSwap(projectileIndex, 1, false);
+
+    m_ProjectileIndices[projectile.Id] = INDEX_NONE;
+    m_FreeProjectileIds.Add(projectile.Id);
+
+    // padding lanes stay at zero
+    for (FAlignedFloats* floats : { &m_PositionX, &m_PositionY, &m_PositionZ, &m_PreviousPositionX, &m_PreviousPositionY, &m_PreviousPositionZ, &m_VelocityX, &m_VelocityY, &m_VelocityZ })
+    {
+        (*floats)[lastIndex] = 0.f;
+        floats->SetNum(Align(m_Projectiles.Num(), 4), false);
+    }
+}
+
+void USDTProjectileManager::ResetProjectile(int32 projectileId)
+{
+    if (!m_ProjectileIndices.IsValidIndex(projectileId) || m_ProjectileIndices[projectileId] == INDEX_NONE)
+        return;
+
+    const int32 projectileIndex = m_ProjectileIndices[projectileId];
+    const FVector& startLocation = m_Projectiles[projectileIndex].StartLocation;
+    m_PositionX[projectileIndex] = m_PreviousPositionX[projectileIndex] = startLocation.X;
+    m_PositionY[projectileIndex] = m_PreviousPositionY[projectileIndex] = startLocation.Y;
+    m_PositionZ[projectileIndex] = m_PreviousPositionZ[projectileIndex] = startLocation.Z;
+}
+
+void USDTProjectileManager::RegisterPawn(ASoftDesignTrainingCharacter* character)
+{
+    if (character)
+        m_Pawns.AddUnique(character);
+}
+
+void USDTProjectileManager::UnregisterPawn(ASoftDesignTrainingCharacter* character)
+{
+    m_Pawns.RemoveSingleSwap(character);
+}
+
+bool USDTProjectileManager::IsTickable() const
+{
+    const UWorld* world = GetWorld();
+    return !HasAnyFlags(RF_ClassDefaultObject) && world && world->IsGameWorld();
+}
+
+TStatId USDTProjectileManager::GetStatId() const
+{
+    RETURN_QUICK_DECLARE_CYCLE_STAT(USDTProjectileManager, STATGROUP_Tickables);
+}
+
+void USDTProjectileManager::Tick(float deltaTime)
+{
+    if (m_Projectiles.Num() == 0)
+        return;
+
+    Integrate(deltaTime);
+    DetectHits();
+    UpdateInstances();
+}
+
+/*
+ * Moves all the projectiles by their velocity, 4 projectiles per vector operation
+ */
+void USDTProjectileManager::Integrate(float deltaTime)
+{
+    const int32 paddedCount = m_PositionX.Num();
+
+    FMemory::Memcpy(m_PreviousPositionX.GetData(), m_PositionX.GetData(), paddedCount * sizeof(float));
+    FMemory::Memcpy(m_PreviousPositionY.GetData(), m_PositionY.GetData(), paddedCount * sizeof(float));
+    FMemory::Memcpy(m_PreviousPositionZ.GetData(), m_PositionZ.GetData(), paddedCount * sizeof(float));
+
+    const VectorRegister deltaTimes = VectorSetFloat1(deltaTime);
+    float* positionX = m_PositionX.GetData();
+    float* positionY = m_PositionY.GetData();
+    float* positionZ = m_PositionZ.GetData();
+    const float* velocityX = m_VelocityX.GetData();
+    const float* velocityY = m_VelocityY.GetData();
+    const float* velocityZ = m_VelocityZ.GetData();
+
+    for (int32 i = 0; i < paddedCount; i += 4)
+    {
+        VectorStoreAligned(VectorMultiplyAdd(VectorLoadAligned(velocityX + i), deltaTimes, VectorLoadAligned(positionX + i)), positionX + i);
+        VectorStoreAligned(VectorMultiplyAdd(VectorLoadAligned(velocityY + i), deltaTimes, VectorLoadAligned(positionY + i)), positionY + i);
+        VectorStoreAligned(VectorMultiplyAdd(VectorLoadAligned(velocityZ + i), deltaTimes, VectorLoadAligned(positionZ + i)), positionZ + i);
+    }
+}
+
+/*
+ * Kills the pawns whose capsule was crossed by a projectile during the frame.
+ * Pawns are bucketed in a grid once per frame, each projectile only tests the pawns of the cells covered by its swept segment.
+ */
+void USDTProjectileManager::DetectHits()
+{
+    m_PawnCapsules.Reset();
+    m_PawnGrid.Reset();
+
+    for (ASoftDesignTrainingCharacter* character : m_Pawns)
+    {
+        const UCapsuleComponent* capsule = character->GetCapsuleComponent();
+        const float radius = capsule->GetScaledCapsuleRadius();
+        const FVector segmentExtent(0.f, 0.f, FMath::Max(0.f, capsule->GetScaledCapsuleHalfHeight() - radius));
+        const FVector location = capsule->GetComponentLocation();
+
+        const int32 pawnIndex = m_PawnCapsules.Add({ character, location - segmentExtent, location + segmentExtent, radius });
+        m_PawnGrid.FindOrAdd(FIntPoint(FMath::FloorToInt(location.X / m_HitGridCellSize), FMath::FloorToInt(location.Y / m_HitGridCellSize))).Add(pawnIndex);
+    }
+
+    if (m_PawnCapsules.Num() == 0)
+        return;
+
+    // pawns may overlap the neighboring cells up to their radius
+    float maxPawnRadius = 0.f;
+    for (const FPawnCapsule& pawnCapsule : m_PawnCapsules)
+    {
+        maxPawnRadius = FMath::Max(maxPawnRadius, pawnCapsule.Radius);
+    }
+
+    TArray<bool, TInlineAllocator<64>> pawnsHit;
+    pawnsHit.SetNumZeroed(m_PawnCapsules.Num());
+
+    for (int32 projectileIndex = 0; projectileIndex < m_Projectiles.Num(); ++projectileIndex)
+    {
+        if (!m_Projectiles[projectileIndex].Fired)
+            continue;
+
+        const FVector start(m_PreviousPositionX[projectileIndex], m_PreviousPositionY[projectileIndex], m_PreviousPositionZ[projectileIndex]);
+        const FVector end(m_PositionX[projectileIndex], m_PositionY[projectileIndex], m_PositionZ[projectileIndex]);
+        const float radius = m_Projectiles[projectileIndex].Radius;
+        const float reach = radius + maxPawnRadius;
+
+        const FIntPoint minCell(FMath::FloorToInt((FMath::Min(start.X, end.X) - reach) / m_HitGridCellSize), FMath::FloorToInt((FMath::Min(start.Y, end.Y) - reach) / m_HitGridCellSize));
+        const FIntPoint maxCell(FMath::FloorToInt((FMath::Max(start.X, end.X) + reach) / m_HitGridCellSize), FMath::FloorToInt((FMath::Max(start.Y, end.Y) + reach) / m_HitGridCellSize));
+
+        for (int32 y = minCell.Y; y <= maxCell.Y; ++y)
+        {
+            for (int32 x = minCell.X; x <= maxCell.X; ++x)
+            {
+                const auto* cellPawns = m_PawnGrid.Find(FIntPoint(x, y));
+                if (!cellPawns)
+                    continue;
+
+                for (int32 pawnIndex : *cellPawns)
+                {
+                    const FPawnCapsule& pawnCapsule = m_PawnCapsules[pawnIndex];
+
+                    FVector projectilePoint, pawnPoint;
+                    FMath::SegmentDistToSegmentSafe(start, end, pawnCapsule.Bottom, pawnCapsule.Top, projectilePoint, pawnPoint);
+                    if (FVector::DistSquared(projectilePoint, pawnPoint) <= FMath::Square(radius + pawnCapsule.Radius))
+                        pawnsHit[pawnIndex] = true;
+                }
+            }
+        }
+    }
+
+    // pawns are moved when they die, so they are only killed once all the tests are done
+    for (int32 pawnIndex = 0; pawnIndex < m_PawnCapsules.Num(); ++pawnIndex)
+    {
+        if (pawnsHit[pawnIndex])
+            m_PawnCapsules[pawnIndex].Character->Die();
+    }
+}
+
+void USDTProjectileManager::UpdateInstances()
+{
+    for (int32 rendererIndex = 0; rendererIndex < m_Renderers.Num(); ++rendererIndex)
+    {
+        FRenderer& renderer = m_Renderers[rendererIndex];
+        for (int32 instanceIndex = 0; instanceIndex < renderer.Projectiles.Num(); ++instanceIndex)
+        {
+            const int32 projectileIndex = renderer.Projectiles[instanceIndex];
+            renderer.InstanceTransforms[instanceIndex].SetLocation(FVector(m_PositionX[projectileIndex], m_PositionY[projectileIndex], m_PositionZ[projectileIndex]));
+        }
+
+        m_RendererComponents[rendererIndex]->BatchUpdateInstancesTransforms(0, renderer.InstanceTransforms, true, true, true);
+    }
+}
+
+/*
+ * Creates the instanced static mesh drawing the projectiles of a class, from the mesh and materials of its class defaults
+ */
+int32 USDTProjectileManager::FindOrAddRenderer(TSubclassOf<ASDTProjectile> projectileClass)
+{
+    if (!projectileClass)
+        return INDEX_NONE;
+
+    const int32 existingIndex = m_Renderers.IndexOfByPredicate([projectileClass](const FRenderer& renderer) { return renderer.ProjectileClass == projectileClass; });
+    if (existingIndex != INDEX_NONE)
+        return existingIndex;
+
+    const UStaticMeshComponent* meshTemplate = projectileClass->GetDefaultObject<ASDTProjectile>()->GetStaticMeshComponent();
+    UStaticMesh* mesh = meshTemplate ? meshTemplate->GetStaticMesh() : nullptr;
+    if (!mesh)
+    {
+        UE_LOG(LogSoftDesignTraining, Warning, TEXT("Projectile class %s has no static mesh, its projectiles are not simulated."), *projectileClass->GetName());
+        return INDEX_NONE;
+    }
+
+    if (!m_RendererActor)
+    {
+        FActorSpawnParameters spawnParameters;
+        spawnParameters.ObjectFlags |= RF_Transient;
+        m_RendererActor = GetWorld()->SpawnActor<AActor>(AActor::StaticClass(), FTransform::Identity, spawnParameters);
+        m_RendererActor->SetRootComponent(NewObject<USceneComponent>(m_RendererActor, TEXT("Root")));
+        m_RendererActor->GetRootComponent()->RegisterComponent();
+    }
+
+    UInstancedStaticMeshComponent* component = NewObject<UInstancedStaticMeshComponent>(m_RendererActor);
+    component->SetupAttachment(m_RendererActor->GetRootComponent());
+    component->SetStaticMesh(mesh);
+    for (int32 materialIndex = 0; materialIndex < meshTemplate->GetNumMaterials(); ++materialIndex)
+    {
+        component->SetMaterial(materialIndex, meshTemplate->GetMaterial(materialIndex));
+    }
+    component->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+    component->SetCanEverAffectNavigation(false);
+    component->SetMobility(EComponentMobility::Movable);
+    component->RegisterComponent();
+
+    const FVector scale = meshTemplate->GetRelativeScale3D();
+    const float radius = mesh->GetBounds().SphereRadius * scale.GetAbsMax();
+
+    m_RendererComponents.Add(component);
+    return m_Renderers.Add({ projectileClass, scale, radius, {}, {} });
+}
@@ -0,0 +1,114 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Tickable.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "SDTProjectileManager.generated.h"
+
+class ASDTProjectile;
+class ASoftDesignTrainingCharacter;
+class UInstancedStaticMeshComponent;
+
+/**
+ * Simulates the projectiles of the spawners without one actor per projectile.
+ * Positions and velocities are stored as structure of arrays and integrated 4 projectiles at a time. Hits are swept segment
+ * against capsule tests with the pawns found in a grid around each projectile, and projectiles are drawn with one instanced
+ * static mesh per projectile class, using the mesh of the class defaults.
+ */
+UCLASS(config = Game)
+class SOFTDESIGNTRAINING_API USDTProjectileManager : public UWorldSubsystem, public FTickableGameObject
+{
+    GENERATED_BODY()
+
+public:
+    // Creates the simulation slots and instances of projectiles parked at the transform, hidden and not moving, and adds their identifiers
+    void Prewarm(const AActor* owner, TSubclassOf<ASDTProjectile> projectileClass, int32 projectileCount, const FTransform& transform, TArray<int32>& outProjectileIds);
+
+    // Starts a prewarmed projectile moving at constant velocity
+    void FireProjectile(int32 projectileId, const FTransform& transform, const FVector& velocity);
+
+    // Removes all the projectiles prewarmed by the owner
+    void RemoveProjectiles(const AActor* owner);
+
+    // Moves the projectile back to where it was added
+    void ResetProjectile(int32 projectileId);
+
+    int32 GetProjectileCount() const { return m_Projectiles.Num(); }
+
+    // Pawns the projectiles can hit
+    void RegisterPawn(ASoftDesignTrainingCharacter* character);
+    void UnregisterPawn(ASoftDesignTrainingCharacter* character);
+
+    virtual void Tick(float deltaTime) override;
+    virtual bool IsTickable() const override;
+    virtual TStatId GetStatId() const override;
+    virtual UWorld* GetTickableGameObjectWorld() const override { return GetWorld(); }
+
+    // Size of a cell of the pawn grid used for the hit tests, in world units
+    UPROPERTY(config)
+    float m_HitGridCellSize = 500.f;
+
+private:
+    typedef TArray<float, TAlignedHeapAllocator<16>> FAlignedFloats;
+
+    void Integrate(float deltaTime);
+    void DetectHits();
+    void UpdateInstances();
+    int32 FindOrAddRenderer(TSubclassOf<ASDTProjectile> projectileClass);
+    int32 AddParkedProjectile(const AActor* owner, int32 rendererIndex, const FTransform& transform);
+    void RemoveProjectileAt(int32 projectileIndex);
+
+    // Hot data, padded to a multiple of 4 projectiles
+    FAlignedFloats m_PositionX, m_PositionY, m_PositionZ;
+    FAlignedFloats m_PreviousPositionX, m_PreviousPositionY, m_PreviousPositionZ;
+    FAlignedFloats m_VelocityX, m_VelocityY, m_VelocityZ;
+
+    // Cold data
+    struct FProjectile
+    {
+        const AActor* Owner;
+        int32 Id;
+        FVector StartLocation;
+        FQuat Rotation;
+        float Radius;
+        int32 RendererIndex;
+        int32 InstanceIndex;
+        bool Fired;
+    };
+    TArray<FProjectile> m_Projectiles;
+
+    // Projectiles are swap-removed, their identifiers stay valid through this indirection
+    TArray<int32> m_ProjectileIndices;
+    TArray<int32> m_FreeProjectileIds;
+
+    struct FRenderer
+    {
+        UClass* ProjectileClass;
+        FVector Scale;
+        float Radius;
+        TArray<int32> Projectiles;
+        TArray<FTransform> InstanceTransforms;
+    };
+    TArray<FRenderer> m_Renderers;
+
+    UPROPERTY()
+    AActor* m_RendererActor = nullptr;
+
+    UPROPERTY()
+    TArray<UInstancedStaticMeshComponent*> m_RendererComponents;
+
+    UPROPERTY()
+    TArray<ASoftDesignTrainingCharacter*> m_Pawns;
+
+    struct FPawnCapsule
+    {
+        ASoftDesignTrainingCharacter* Character;
+        FVector Bottom;
+        FVector Top;
+        float Radius;
+    };
+    TArray<FPawnCapsule> m_PawnCapsules;
+    TMap<FIntPoint, TArray<int32, TInlineAllocator<4>>> m_PawnGrid;
+};
@@ -2,9 +2,11 @@
 
 #include "SDTProjectileSpawner.h"
 #include "SoftDesignTraining.h"
+#include "SDTHazardSubsystem.h"
+#include "SDTProjectileManager.h"
+#include "SDTSpawnerScheduler.h"
 
 #include "Engine/World.h"
-#include "TimerManager.h"
 
 
 ASDTProjectileSpawner::ASDTProjectileSpawner()
@@ -15,10 +17,35 @@ void ASDTProjectileSpawner::BeginPlay()
 {
     Super::BeginPlay();
 
-    //shoot a projectile on spawn
-    FireProjectile();
+    PrewarmProjectiles();
+
+    // the scheduler spreads the shots of all the spawners across frames
+    USDTSpawnerScheduler* scheduler = GetWorld()->GetSubsystem<USDTSpawnerScheduler>();
+    if (!scheduler)
+        return;
+
+    const float firstShotTime = scheduler->RegisterSpawner(this);
+
+    // the lane of the projectiles is known from the shot schedule
+    if (USDTHazardSubsystem* hazards = GetWorld()->GetSubsystem<USDTHazardSubsystem>())
+        hazards->RegisterSpawner(this, firstShotTime);
+}
+
+void ASDTProjectileSpawner::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+    if (USDTSpawnerScheduler* scheduler = GetWorld()->GetSubsystem<USDTSpawnerScheduler>())
+        scheduler->UnregisterSpawner(this);
+
+    if (USDTHazardSubsystem* hazards = GetWorld()->GetSubsystem<USDTHazardSubsystem>())
+        hazards->UnregisterSpawner(this);
+
+    if (USDTProjectileManager* projectileManager = GetWorld()->GetSubsystem<USDTProjectileManager>())
+        projectileManager->RemoveProjectiles(this);
+    m_ManagedProjectiles.Reset();
+    m_FiredProjectileCount = 0;
+    m_OldestProjectileIndex = 0;
 
-    GetWorldTimerManager().SetTimer(m_ShotCooldownTimer, this, &ASDTProjectileSpawner::OnReadyToShoot, m_TimeToShoot, true);
+    Super::EndPlay(EndPlayReason);
 }
 
 void ASDTProjectileSpawner::OnReadyToShoot()
@@ -26,30 +53,66 @@ void ASDTProjectileSpawner::OnReadyToShoot()
     FireProjectile();
 }
 
-void ASDTProjectileSpawner::FireProjectile()
+/*
+ * Allocates all the projectiles of the spawner up front so firing never spawns anything
+ */
+void ASDTProjectileSpawner::PrewarmProjectiles()
 {
-    if (m_Projectiles.Num() >= m_MaxSimultaneousProjectiles)
+    if (m_UseProjectileManager)
     {
-        ResetOldestProjectile();
+        if (USDTProjectileManager* projectileManager = GetWorld()->GetSubsystem<USDTProjectileManager>())
+            projectileManager->Prewarm(this, m_SDTProjectileBP, m_MaxSimultaneousProjectiles, FTransform(GetActorRotation(), GetActorLocation()), m_ManagedProjectiles);
+        return;
     }
-    else
+
+    m_Projectiles.Reserve(m_MaxSimultaneousProjectiles);
+    for (int32 i = 0; i < m_MaxSimultaneousProjectiles; ++i)
     {
         ASDTProjectile* projectile = GetWorld()->SpawnActor<class ASDTProjectile>(m_SDTProjectileBP, GetActorLocation(), GetActorRotation());
+        if (!projectile)
+            break;
+
+        projectile->DeactivateProjectile();
         m_Projectiles.Add(projectile);
+    }
+}
 
-        projectile->FireProjectile(m_ShotDirection, m_ShotSpeed);
+void ASDTProjectileSpawner::FireProjectile()
+{
+    const int32 poolSize = m_UseProjectileManager ? m_ManagedProjectiles.Num() : m_Projectiles.Num();
+    if (poolSize == 0)
+        return;
+
+    if (m_FiredProjectileCount >= poolSize)
+    {
+        ResetOldestProjectile();
+    }
+    else if (m_UseProjectileManager)
+    {
+        if (USDTProjectileManager* projectileManager = GetWorld()->GetSubsystem<USDTProjectileManager>())
+            projectileManager->FireProjectile(m_ManagedProjectiles[m_FiredProjectileCount], FTransform(GetActorRotation(), GetActorLocation()), m_ShotDirection * m_ShotSpeed);
+        ++m_FiredProjectileCount;
+    }
+    else
+    {
+        m_Projectiles[m_FiredProjectileCount]->FireProjectile(m_ShotDirection, m_ShotSpeed);
+        ++m_FiredProjectileCount;
     }
 }
 
 void ASDTProjectileSpawner::ResetOldestProjectile()
 {
-    m_Projectiles[m_OldestProjectileIndex]->ResetProjectile();
+    if (m_UseProjectileManager)
+    {
+        if (USDTProjectileManager* projectileManager = GetWorld()->GetSubsystem<USDTProjectileManager>())
+            projectileManager->ResetProjectile(m_ManagedProjectiles[m_OldestProjectileIndex]);
+    }
+    else
+    {
+        m_Projectiles[m_OldestProjectileIndex]->ResetProjectile();
+    }
     ++m_OldestProjectileIndex;
 
-    if (m_OldestProjectileIndex >= m_Projectiles.Num())
+    if (m_OldestProjectileIndex >= m_FiredProjectileCount)
         m_OldestProjectileIndex = 0;
 }
-
-
-
-
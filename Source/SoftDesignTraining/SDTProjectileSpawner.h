@@ -19,10 +19,16 @@ public:
     // Sets default values for this actor's properties
     ASDTProjectileSpawner();
 
-protected:
     virtual void BeginPlay() override;
+    virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 
     void OnReadyToShoot();
+    float GetTimeToShoot() const { return m_TimeToShoot; }
+    FVector GetShotVelocity() const { return m_ShotDirection * m_ShotSpeed; }
+    int32 GetMaxSimultaneousProjectiles() const { return m_MaxSimultaneousProjectiles; }
+
+protected:
+    void PrewarmProjectiles();
     void FireProjectile();
     void ResetOldestProjectile();
 
@@ -41,7 +47,13 @@ protected:
     UPROPERTY(EditAnywhere)
         int32 m_MaxSimultaneousProjectiles = 5;
 
-    FTimerHandle m_ShotCooldownTimer;
+    // Simulates the projectiles in the projectile manager instead of spawning one actor per projectile
+    UPROPERTY(EditAnywhere)
+        bool m_UseProjectileManager = true;
+
+    // Projectile pool, allocated when the spawner begins play
     TArray<ASDTProjectile*> m_Projectiles;
+    TArray<int32> m_ManagedProjectiles;
+    int32 m_FiredProjectileCount = 0;
     int32 m_OldestProjectileIndex = 0;
 };
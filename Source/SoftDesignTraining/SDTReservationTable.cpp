@@ -0,0 +1,91 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "SDTReservationTable.h"
+#include "SoftDesignTraining.h"
+
+int32 FSDTReservationTable::AllocateAgent()
+{
+    const int32 agentId = m_FreeAgents.Num() > 0 ? m_FreeAgents.Pop(false) : m_AgentClaims.Add(INDEX_NONE);
+    m_AgentClaims[agentId] = INDEX_NONE;
+    return agentId;
+}
+
+void FSDTReservationTable::FreeAgent(int32 agentId)
+{
+    if (!m_AgentClaims.IsValidIndex(agentId))
+        return;
+
+    ReleaseAgent(agentId);
+    m_FreeAgents.Add(agentId);
+}
+
+int32 FSDTReservationTable::AllocateSlot()
+{
+    const int32 slot = m_FreeSlots.Num() > 0 ? m_FreeSlots.Pop(false) : m_SlotClaimants.Add(INDEX_NONE);
+    m_SlotClaimants[slot] = INDEX_NONE;
+    return slot;
+}
+
+void FSDTReservationTable::FreeSlot(int32 slot)
+{
+    if (!m_SlotClaimants.IsValidIndex(slot))
+        return;
+
+    ReleaseSlot(slot);
+    m_FreeSlots.Add(slot);
+}
+
+/*
+ * Claims the slot if it is free or already claimed by the agent, and releases the previous claim of the agent
+ */
+bool FSDTReservationTable::Claim(int32 slot, int32 agentId)
+{
+    if (!m_SlotClaimants.IsValidIndex(slot) || !m_AgentClaims.IsValidIndex(agentId))
+        return false;
+
+    const int32 previousClaimant = FPlatformAtomics::InterlockedCompareExchange(&m_SlotClaimants[slot], agentId, INDEX_NONE);
+    if (previousClaimant != INDEX_NONE && previousClaimant != agentId)
+        return false;
+
+    const int32 previousSlot = FPlatformAtomics::InterlockedExchange(&m_AgentClaims[agentId], slot);
+    if (previousSlot != INDEX_NONE && previousSlot != slot)
+        FPlatformAtomics::InterlockedCompareExchange(&m_SlotClaimants[previousSlot], INDEX_NONE, agentId);
+
+    return true;
+}
+
+void FSDTReservationTable::ReleaseAgent(int32 agentId)
+{
+    if (!m_AgentClaims.IsValidIndex(agentId))
+        return;
+
+    const int32 slot = FPlatformAtomics::InterlockedExchange(&m_AgentClaims[agentId], INDEX_NONE);
+    if (slot != INDEX_NONE)
+        FPlatformAtomics::InterlockedCompareExchange(&m_SlotClaimants[slot], INDEX_NONE, agentId);
+}
+
+void FSDTReservationTable::ReleaseSlot(int32 slot)
+{
+    if (!m_SlotClaimants.IsValidIndex(slot))
+        return;
+
+    const int32 claimant = FPlatformAtomics::InterlockedExchange(&m_SlotClaimants[slot], INDEX_NONE);
+    if (claimant != INDEX_NONE)
+        FPlatformAtomics::InterlockedCompareExchange(&m_AgentClaims[claimant], INDEX_NONE, slot);
+}
+
+int32 FSDTReservationTable::GetClaimant(int32 slot) const
+{
+    return m_SlotClaimants.IsValidIndex(slot) ? FPlatformAtomics::AtomicRead(&m_SlotClaimants[slot]) : INDEX_NONE;
+}
+
+int32 FSDTReservationTable::GetClaimedSlot(int32 agentId) const
+{
+    return m_AgentClaims.IsValidIndex(agentId) ? FPlatformAtomics::AtomicRead(&m_AgentClaims[agentId]) : INDEX_NONE;
+}
+
+bool FSDTReservationTable::IsClaimedByOther(int32 slot, int32 agentId) const
+{
+    const int32 claimant = GetClaimant(slot);
+    return claimant != INDEX_NONE && claimant != agentId;
+}
@@ -0,0 +1,42 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Claims of agents on slots (one per reservable object), both identified by compact indices.
+ * An agent holds at most one claim: claiming a slot releases its previous one.
+ * Claims and releases are atomic and can be done from any thread. Agents and slots are allocated on the game thread,
+ * outside of the phases running decisions on worker threads.
+ */
+class SOFTDESIGNTRAINING_API FSDTReservationTable
+{
+public:
+    int32 AllocateAgent();
+    void FreeAgent(int32 agentId);
+
+    int32 AllocateSlot();
+    void FreeSlot(int32 slot);
+
+    bool Claim(int32 slot, int32 agentId);
+    void ReleaseAgent(int32 agentId);
+    void ReleaseSlot(int32 slot);
+
+    int32 GetClaimant(int32 slot) const;
+    int32 GetClaimedSlot(int32 agentId) const;
+    bool IsClaimedByOther(int32 slot, int32 agentId) const;
+
+    // Number of slots ever allocated, free slots included
+    int32 GetSlotCount() const { return m_SlotClaimants.Num(); }
+
+private:
+    // Agent claiming each slot, or INDEX_NONE
+    TArray<int32> m_SlotClaimants;
+
+    // Slot claimed by each agent, or INDEX_NONE
+    TArray<int32> m_AgentClaims;
+
+    TArray<int32> m_FreeSlots;
+    TArray<int32> m_FreeAgents;
+};
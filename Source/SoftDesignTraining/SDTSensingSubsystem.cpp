@@ -0,0 +1,100 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "SDTSensingSubsystem.h"
+#include "SoftDesignTraining.h"
+#include "SDTAIController.h"
+#include "SDTAIScheduler.h"
+#include "SDTVisibilitySubsystem.h"
+#include "SDTWorldSnapshot.h"
+#include "Algo/BinarySearch.h"
+
+namespace
+{
+    uint64 GetCellKey(const FVector& location, float cellSize)
+    {
+        const int32 x = FMath::FloorToInt(location.X / cellSize);
+        const int32 y = FMath::FloorToInt(location.Y / cellSize);
+        return (uint64(uint32(x)) << 32) | uint64(uint32(y));
+    }
+}
+
+AActor* USDTSensingSubsystem::GetVisiblePlayer(const ASDTAIController* controller)
+{
+    // the first request of the frame runs the sensing for all the agents
+    if (m_LastUpdateFrame != GFrameCounter)
+    {
+        m_LastUpdateFrame = GFrameCounter;
+        UpdateSensing();
+    }
+
+    return m_ControllersSeeingPlayer.Contains(controller) ? m_Player.Get() : nullptr;
+}
+
+void USDTSensingSubsystem::UpdateSensing()
+{
+    m_ControllersSeeingPlayer.Reset();
+    m_Agents.Reset();
+    m_AgentCells.Reset();
+
+    UWorld* world = GetWorld();
+    const USDTWorldSnapshotSubsystem* snapshots = world->GetSubsystem<USDTWorldSnapshotSubsystem>();
+    const FSDTWorldSnapshotPtr snapshot = snapshots ? snapshots->GetSnapshot() : FSDTWorldSnapshotPtr();
+    USDTAIScheduler* scheduler = world->GetSubsystem<USDTAIScheduler>();
+    m_Player = snapshot ? snapshot->Player : nullptr;
+    if (!snapshot || !snapshot->HasPlayer() || !scheduler)
+        return;
+
+    const float playerRadius = snapshot->PlayerRadius;
+    const FVector playerLocation = snapshot->PlayerLocation;
+    const FVector playerAxis(0.f, 0.f, snapshot->PlayerHalfHeight);
+
+    // gather the agents, the grid cells are large enough to hold the longest vision capsule
+    float cellSize = 1.f;
+    for (int32 i = 0; i < scheduler->GetControllerCount(); ++i)
+    {
+        const ASDTAIController* controller = Cast<ASDTAIController>(scheduler->GetController(i));
+        const APawn* pawn = controller ? controller->GetPawn() : nullptr;
+        if (!pawn)
+            continue;
+
+        const float reach = controller->m_DetectionCapsuleForwardStartingOffset + controller->m_DetectionCapsuleHalfLength * 2 + controller->m_DetectionCapsuleRadius;
+        cellSize = FMath::Max(cellSize, reach + playerRadius);
+
+        m_Agents.Add({ controller, pawn->GetActorLocation(), pawn->GetActorForwardVector() });
+    }
+
+    for (int32 i = 0; i < m_Agents.Num(); ++i)
+    {
+        m_AgentCells.Emplace(GetCellKey(m_Agents[i].Location, cellSize), i);
+    }
+    m_AgentCells.Sort([](const TPair<uint64, int32>& cell1, const TPair<uint64, int32>& cell2) { return cell1.Key < cell2.Key; });
+
+    // only the agents of the cells around the player can see it
+    for (int32 y = -1; y <= 1; ++y)
+    {
+        for (int32 x = -1; x <= 1; ++x)
+        {
+            const uint64 cellKey = GetCellKey(playerLocation + FVector(x * cellSize, y * cellSize, 0.f), cellSize);
+            int32 cellIndex = Algo::LowerBoundBy(m_AgentCells, cellKey, [](const TPair<uint64, int32>& cell) { return cell.Key; });
+
+            for (; cellIndex < m_AgentCells.Num() && m_AgentCells[cellIndex].Key == cellKey; ++cellIndex)
+            {
+                const FSensingAgent& agent = m_Agents[m_AgentCells[cellIndex].Value];
+                const ASDTAIController* controller = agent.Controller;
+
+                // the vision capsule is the sweep of a sphere along the detection segment
+                const FVector detectionStartLocation = agent.Location + agent.Forward * controller->m_DetectionCapsuleForwardStartingOffset;
+                const FVector detectionEndLocation = detectionStartLocation + agent.Forward * controller->m_DetectionCapsuleHalfLength * 2;
+
+                FVector closestOnDetection;
+                FVector closestOnPlayer;
+                FMath::SegmentDistToSegmentSafe(detectionStartLocation, detectionEndLocation, playerLocation - playerAxis, playerLocation + playerAxis, closestOnDetection, closestOnPlayer);
+
+                const bool playerInCapsule = FVector::DistSquared(closestOnDetection, closestOnPlayer) <= FMath::Square(controller->m_DetectionCapsuleRadius + playerRadius);
+                // same visibility query as the blocking perception: the baked visibility, then the line of sight trace
+                if (playerInCapsule && USDTVisibilitySubsystem::IsVisible(world, agent.Location, playerLocation))
+                    m_ControllersSeeingPlayer.Add(controller);
+            }
+        }
+    }
+}
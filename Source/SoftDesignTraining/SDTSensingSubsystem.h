@@ -0,0 +1,42 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "SDTSensingSubsystem.generated.h"
+
+class ASDTAIController;
+
+/**
+ * Shared player sensing, run once per frame from the player's side.
+ * The AI pawns are bucketed in a grid and only the ones near the player get their vision capsule tested analytically
+ * against the player capsule. A line of sight trace is only done for the pawns whose vision capsule contains the player.
+ */
+UCLASS()
+class SOFTDESIGNTRAINING_API USDTSensingSubsystem : public UWorldSubsystem
+{
+    GENERATED_BODY()
+
+public:
+    // Returns the player if it is in the vision capsule of the controller's pawn and directly visible to it
+    AActor* GetVisiblePlayer(const ASDTAIController* controller);
+
+private:
+    void UpdateSensing();
+
+    struct FSensingAgent
+    {
+        const ASDTAIController* Controller;
+        FVector Location;
+        FVector Forward;
+    };
+    TArray<FSensingAgent> m_Agents;
+
+    // Agents sorted by grid cell, the key packs the cell coordinates
+    TArray<TPair<uint64, int32>> m_AgentCells;
+
+    TSet<const ASDTAIController*> m_ControllersSeeingPlayer;
+    TWeakObjectPtr<AActor> m_Player;
+    uint64 m_LastUpdateFrame = MAX_uint64;
+};
@@ -0,0 +1,69 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "SDTSpawnerScheduler.h"
+#include "SoftDesignTraining.h"
+#include "SDTProjectileSpawner.h"
+
+float USDTSpawnerScheduler::RegisterSpawner(ASDTProjectileSpawner* spawner)
+{
+    if (!spawner)
+        return 0.f;
+
+    if (const FScheduledSpawner* scheduled = m_Spawners.FindByPredicate([spawner](const FScheduledSpawner& other) { return other.Spawner == spawner; }))
+        return scheduled->NextShotTime;
+
+    // the fractional parts of multiples of the golden ratio are evenly spread, whatever the number of spawners
+    const float phase = FMath::Frac(m_RegisteredCount++ * 0.618034f);
+    return m_Spawners.Add_GetRef({ spawner, GetWorld()->GetTimeSeconds() + phase * spawner->GetTimeToShoot() }).NextShotTime;
+}
+
+void USDTSpawnerScheduler::UnregisterSpawner(ASDTProjectileSpawner* spawner)
+{
+    m_Spawners.RemoveAll([spawner](const FScheduledSpawner& scheduled) { return scheduled.Spawner == spawner; });
+}
+
+bool USDTSpawnerScheduler::IsTickable() const
+{
+    const UWorld* world = GetWorld();
+    return !HasAnyFlags(RF_ClassDefaultObject) && world && world->IsGameWorld();
+}
+
+TStatId USDTSpawnerScheduler::GetStatId() const
+{
+    RETURN_QUICK_DECLARE_CYCLE_STAT(USDTSpawnerScheduler, STATGROUP_Tickables);
+}
+
+/*
+ * Fires the due spawners, the most overdue first, up to the per frame cap
+ */
+void USDTSpawnerScheduler::Tick(float deltaTime)
+{
+    const float currentTime = GetWorld()->GetTimeSeconds();
+
+    m_DueSpawners.Reset();
+    for (int32 i = 0; i < m_Spawners.Num(); ++i)
+    {
+        if (m_Spawners[i].NextShotTime <= currentTime)
+            m_DueSpawners.Add(i);
+    }
+
+    if (m_DueSpawners.Num() > m_MaxShotsPerFrame)
+    {
+        m_DueSpawners.Sort([this](int32 index1, int32 index2) {
+            return m_Spawners[index1].NextShotTime < m_Spawners[index2].NextShotTime;
+        });
+        m_DueSpawners.SetNum(FMath::Max(1, m_MaxShotsPerFrame), false);
+    }
+
+    for (int32 index : m_DueSpawners)
+    {
+        FScheduledSpawner& scheduled = m_Spawners[index];
+        scheduled.Spawner->OnReadyToShoot();
+
+        // keep the phase of the spawner, skipping the shots missed during a long frame
+        const float period = FMath::Max(scheduled.Spawner->GetTimeToShoot(), KINDA_SMALL_NUMBER);
+        scheduled.NextShotTime += period;
+        if (scheduled.NextShotTime <= currentTime - period)
+            scheduled.NextShotTime += FMath::FloorToFloat((currentTime - scheduled.NextShotTime) / period) * period;
+    }
+}
@@ -0,0 +1,47 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Tickable.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "SDTSpawnerScheduler.generated.h"
+
+class ASDTProjectileSpawner;
+
+/**
+ * Fires the projectile spawners instead of one looping timer per spawner.
+ * Each spawner gets a phase offset within its period from a golden ratio sequence, so spawners sharing the same period
+ * do not all fire on the same frame. The number of shots per frame is also capped: overdue spawners fire on the next
+ * frames without shifting their schedule.
+ */
+UCLASS(config = Game)
+class SOFTDESIGNTRAINING_API USDTSpawnerScheduler : public UWorldSubsystem, public FTickableGameObject
+{
+    GENERATED_BODY()
+
+public:
+    // Returns the time of the first shot of the spawner
+    float RegisterSpawner(ASDTProjectileSpawner* spawner);
+    void UnregisterSpawner(ASDTProjectileSpawner* spawner);
+
+    virtual void Tick(float deltaTime) override;
+    virtual bool IsTickable() const override;
+    virtual TStatId GetStatId() const override;
+    virtual UWorld* GetTickableGameObjectWorld() const override { return GetWorld(); }
+
+    // Maximum number of spawners firing on the same frame
+    UPROPERTY(config)
+    int32 m_MaxShotsPerFrame = 16;
+
+private:
+    struct FScheduledSpawner
+    {
+        ASDTProjectileSpawner* Spawner;
+        float NextShotTime;
+    };
+    TArray<FScheduledSpawner> m_Spawners;
+    TArray<int32> m_DueSpawners;
+
+    int32 m_RegisteredCount = 0;
+};
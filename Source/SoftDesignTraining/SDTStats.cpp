@@ -0,0 +1,44 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "SDTStats.h"
+#include "SoftDesignTraining.h"
+
+CSV_DEFINE_CATEGORY_MODULE(SOFTDESIGNTRAINING_API, SoftDesignTrainingAI, true);
+
+DEFINE_STAT(STAT_SDT_GatherDecisions);
+DEFINE_STAT(STAT_SDT_ComputeDecisions);
+DEFINE_STAT(STAT_SDT_ApplyDecisions);
+DEFINE_STAT(STAT_SDT_GatherDecisionInput);
+DEFINE_STAT(STAT_SDT_ChooseTarget);
+DEFINE_STAT(STAT_SDT_UpdatePlayerInteraction);
+DEFINE_STAT(STAT_SDT_UpdateBehavior);
+DEFINE_STAT(STAT_SDT_CaptureWorldSnapshot);
+
+DEFINE_STAT(STAT_SDT_DetectInVisionCapsule);
+DEFINE_STAT(STAT_SDT_RequestAsyncPerception);
+DEFINE_STAT(STAT_SDT_ConsumeAsyncPerception);
+DEFINE_STAT(STAT_SDT_TargetIsVisible);
+DEFINE_STAT(STAT_SDT_GetHightestPriorityDetectionHit);
+DEFINE_STAT(STAT_SDT_Raycast);
+DEFINE_STAT(STAT_SDT_IsPlayerPoweredUp);
+
+DEFINE_STAT(STAT_SDT_GoToBestCollectible);
+DEFINE_STAT(STAT_SDT_ApplyCollectiblePathBatch);
+DEFINE_STAT(STAT_SDT_GetBestFleeLocation);
+DEFINE_STAT(STAT_SDT_GoToBestFleeLocation);
+DEFINE_STAT(STAT_SDT_GoToPlayer);
+DEFINE_STAT(STAT_SDT_FollowPathSegment);
+DEFINE_STAT(STAT_SDT_SetMoveSegment);
+DEFINE_STAT(STAT_SDT_WaitForSafeCrossing);
+DEFINE_STAT(STAT_SDT_ShowNavigationPath);
+
+DEFINE_STAT(STAT_SDT_StartJump);
+DEFINE_STAT(STAT_SDT_UpdateJump);
+
+DEFINE_STAT(STAT_SDT_PathQueries);
+DEFINE_STAT(STAT_SDT_Traces);
+DEFINE_STAT(STAT_SDT_Retargets);
+DEFINE_STAT(STAT_SDT_LOSCacheHits);
+DEFINE_STAT(STAT_SDT_LOSCacheMisses);
+DEFINE_STAT(STAT_SDT_LOSCacheEvictions);
+DEFINE_STAT(STAT_SDT_LOSCacheBlockerLookups);
@@ -0,0 +1,65 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Stats/Stats.h"
+#include "ProfilingDebugging/CsvProfiler.h"
+
+/**
+ * Stats of the AI, shown with "stat SoftDesignTrainingAI" and in Unreal Insights, also recorded by the CSV profiler
+ */
+DECLARE_STATS_GROUP(TEXT("SoftDesignTrainingAI"), STATGROUP_SoftDesignTrainingAI, STATCAT_Advanced);
+
+CSV_DECLARE_CATEGORY_MODULE_EXTERN(SOFTDESIGNTRAINING_API, SoftDesignTrainingAI);
+
+// Decision
+DECLARE_CYCLE_STAT_EXTERN(TEXT("GatherDecisions"), STAT_SDT_GatherDecisions, STATGROUP_SoftDesignTrainingAI, SOFTDESIGNTRAINING_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("ComputeDecisions"), STAT_SDT_ComputeDecisions, STATGROUP_SoftDesignTrainingAI, SOFTDESIGNTRAINING_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("ApplyDecisions"), STAT_SDT_ApplyDecisions, STATGROUP_SoftDesignTrainingAI, SOFTDESIGNTRAINING_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("GatherDecisionInput"), STAT_SDT_GatherDecisionInput, STATGROUP_SoftDesignTrainingAI, SOFTDESIGNTRAINING_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("ChooseTarget"), STAT_SDT_ChooseTarget, STATGROUP_SoftDesignTrainingAI, SOFTDESIGNTRAINING_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("UpdatePlayerInteraction"), STAT_SDT_UpdatePlayerInteraction, STATGROUP_SoftDesignTrainingAI, SOFTDESIGNTRAINING_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("UpdateBehavior"), STAT_SDT_UpdateBehavior, STATGROUP_SoftDesignTrainingAI, SOFTDESIGNTRAINING_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("CaptureWorldSnapshot"), STAT_SDT_CaptureWorldSnapshot, STATGROUP_SoftDesignTrainingAI, SOFTDESIGNTRAINING_API);
+
+// Perception
+DECLARE_CYCLE_STAT_EXTERN(TEXT("DetectInVisionCapsule"), STAT_SDT_DetectInVisionCapsule, STATGROUP_SoftDesignTrainingAI, SOFTDESIGNTRAINING_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("RequestAsyncPerception"), STAT_SDT_RequestAsyncPerception, STATGROUP_SoftDesignTrainingAI, SOFTDESIGNTRAINING_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("ConsumeAsyncPerception"), STAT_SDT_ConsumeAsyncPerception, STATGROUP_SoftDesignTrainingAI, SOFTDESIGNTRAINING_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("TargetIsVisible"), STAT_SDT_TargetIsVisible, STATGROUP_SoftDesignTrainingAI, SOFTDESIGNTRAINING_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("GetHightestPriorityDetectionHit"), STAT_SDT_GetHightestPriorityDetectionHit, STATGROUP_SoftDesignTrainingAI, SOFTDESIGNTRAINING_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Raycast"), STAT_SDT_Raycast, STATGROUP_SoftDesignTrainingAI, SOFTDESIGNTRAINING_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("IsPlayerPoweredUp"), STAT_SDT_IsPlayerPoweredUp, STATGROUP_SoftDesignTrainingAI, SOFTDESIGNTRAINING_API);
+
+// Pathfinding
+DECLARE_CYCLE_STAT_EXTERN(TEXT("GoToBestCollectible"), STAT_SDT_GoToBestCollectible, STATGROUP_SoftDesignTrainingAI, SOFTDESIGNTRAINING_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("ApplyCollectiblePathBatch"), STAT_SDT_ApplyCollectiblePathBatch, STATGROUP_SoftDesignTrainingAI, SOFTDESIGNTRAINING_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("GetBestFleeLocation"), STAT_SDT_GetBestFleeLocation, STATGROUP_SoftDesignTrainingAI, SOFTDESIGNTRAINING_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("GoToBestFleeLocation"), STAT_SDT_GoToBestFleeLocation, STATGROUP_SoftDesignTrainingAI, SOFTDESIGNTRAINING_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("GoToPlayer"), STAT_SDT_GoToPlayer, STATGROUP_SoftDesignTrainingAI, SOFTDESIGNTRAINING_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("FollowPathSegment"), STAT_SDT_FollowPathSegment, STATGROUP_SoftDesignTrainingAI, SOFTDESIGNTRAINING_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("SetMoveSegment"), STAT_SDT_SetMoveSegment, STATGROUP_SoftDesignTrainingAI, SOFTDESIGNTRAINING_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("WaitForSafeCrossing"), STAT_SDT_WaitForSafeCrossing, STATGROUP_SoftDesignTrainingAI, SOFTDESIGNTRAINING_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("ShowNavigationPath"), STAT_SDT_ShowNavigationPath, STATGROUP_SoftDesignTrainingAI, SOFTDESIGNTRAINING_API);
+
+// Jump
+DECLARE_CYCLE_STAT_EXTERN(TEXT("StartJump"), STAT_SDT_StartJump, STATGROUP_SoftDesignTrainingAI, SOFTDESIGNTRAINING_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("UpdateJump"), STAT_SDT_UpdateJump, STATGROUP_SoftDesignTrainingAI, SOFTDESIGNTRAINING_API);
+
+// Counts per frame
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Path queries"), STAT_SDT_PathQueries, STATGROUP_SoftDesignTrainingAI, SOFTDESIGNTRAINING_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Traces"), STAT_SDT_Traces, STATGROUP_SoftDesignTrainingAI, SOFTDESIGNTRAINING_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Retargets"), STAT_SDT_Retargets, STATGROUP_SoftDesignTrainingAI, SOFTDESIGNTRAINING_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("LOS cache hits"), STAT_SDT_LOSCacheHits, STATGROUP_SoftDesignTrainingAI, SOFTDESIGNTRAINING_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("LOS cache misses"), STAT_SDT_LOSCacheMisses, STATGROUP_SoftDesignTrainingAI, SOFTDESIGNTRAINING_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("LOS cache evictions"), STAT_SDT_LOSCacheEvictions, STATGROUP_SoftDesignTrainingAI, SOFTDESIGNTRAINING_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("LOS cache blocker lookups"), STAT_SDT_LOSCacheBlockerLookups, STATGROUP_SoftDesignTrainingAI, SOFTDESIGNTRAINING_API);
+
+#define SDT_SCOPE_CYCLE_STAT(Name) \
+    SCOPE_CYCLE_COUNTER(STAT_SDT_##Name); \
+    CSV_SCOPED_TIMING_STAT(SoftDesignTrainingAI, Name)
+
+#define SDT_INC_COUNTER_STAT(Name, Amount) \
+    INC_DWORD_STAT_BY(STAT_SDT_##Name, Amount); \
+    CSV_CUSTOM_STAT(SoftDesignTrainingAI, Name, Amount, ECsvCustomStatOp::Accumulate)
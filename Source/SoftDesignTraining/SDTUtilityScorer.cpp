@@ -0,0 +1,281 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "SDTUtilityScorer.h"
+#include "SoftDesignTraining.h"
+
+namespace
+{
+    // Score of the rejected candidates, below any accepted score
+    const float RejectedScore = -MAX_FLT;
+
+    void RunBenchmark(const TArray<FString>& args);
+
+    FAutoConsoleCommand UtilityScorerBenchmarkCommand(
+        TEXT("sdt.UtilityScorer.Benchmark"),
+        TEXT("Times the utility scorer against the scalar candidate loops it replaced and checks they pick the same candidates.\n")
+        TEXT("Arguments: candidate count (default 256), iteration count (default 1000)."),
+        FConsoleCommandWithArgsDelegate::CreateStatic(&RunBenchmark));
+}
+
+void FSDTUtilityCandidates::Reset(int32 count)
+{
+    m_Count = count;
+    const int32 paddedCount = Align(count, 4);
+
+    for (FAlignedFloats* floats : { &m_X, &m_Y, &m_DirectionX, &m_DirectionY, &m_Values })
+    {
+        floats->Reset(paddedCount);
+        floats->SetNumZeroed(paddedCount);
+    }
+    for (FAlignedFloats& flags : m_Flags)
+    {
+        flags.Reset(paddedCount);
+        flags.Init(1.f, paddedCount);
+    }
+}
+
+FSDTUtilityScorer& FSDTUtilityScorer::PreferNear(const FVector2D& point, float weight)
+{
+    m_Considerations.Add({ EConsideration::Distance, -weight, point, 0.f, 0 });
+    return *this;
+}
+
+FSDTUtilityScorer& FSDTUtilityScorer::PreferFar(const FVector2D& point, float weight)
+{
+    m_Considerations.Add({ EConsideration::Distance, weight, point, 0.f, 0 });
+    return *this;
+}
+
+FSDTUtilityScorer& FSDTUtilityScorer::AddValue(float weight)
+{
+    m_Considerations.Add({ EConsideration::Value, weight, FVector2D::ZeroVector, 0.f, 0 });
+    return *this;
+}
+
+FSDTUtilityScorer& FSDTUtilityScorer::AddBonus(int32 index, float bonus)
+{
+    m_Bonuses.Emplace(index, bonus);
+    return *this;
+}
+
+FSDTUtilityScorer& FSDTUtilityScorer::RejectToward(const FVector2D& direction, float maxAngle)
+{
+    m_Considerations.Add({ EConsideration::RejectToward, 0.f, direction, FMath::Cos(FMath::DegreesToRadians(maxAngle)), 0 });
+    return *this;
+}
+
+FSDTUtilityScorer& FSDTUtilityScorer::Require(FSDTUtilityCandidates::EFlag flag)
+{
+    m_Considerations.Add({ EConsideration::Require, 0.f, FVector2D::ZeroVector, 0.f, flag });
+    return *this;
+}
+
+void FSDTUtilityScorer::Reset()
+{
+    m_Considerations.Reset();
+    m_Bonuses.Reset();
+}
+
+/*
+ * Scores 4 candidates at a time, the rejections are accumulated in a mask applied once all the considerations are evaluated
+ */
+void FSDTUtilityScorer::Score(const FSDTUtilityCandidates& candidates)
+{
+    const int32 paddedCount = candidates.m_X.Num();
+    m_Scores.Reset(paddedCount);
+    m_Scores.SetNumUninitialized(paddedCount);
+
+    const VectorRegister zero = VectorZero();
+    const VectorRegister half = VectorSetFloat1(0.5f);
+    const VectorRegister epsilon = VectorSetFloat1(KINDA_SMALL_NUMBER);
+    const VectorRegister rejectedScore = VectorSetFloat1(RejectedScore);
+    const VectorRegister allAccepted = VectorCompareEQ(zero, zero);
+
+    for (int32 i = 0; i < paddedCount; i += 4)
+    {
+        VectorRegister score = zero;
+        VectorRegister accepted = allAccepted;
+
+        for (const FConsideration& consideration : m_Considerations)
+        {
+            switch (consideration.Type)
+            {
+            case EConsideration::Distance:
+            {
+                const VectorRegister dx = VectorSubtract(VectorLoadAligned(&candidates.m_X[i]), VectorSetFloat1(consideration.Vector.X));
+                const VectorRegister dy = VectorSubtract(VectorLoadAligned(&candidates.m_Y[i]), VectorSetFloat1(consideration.Vector.Y));
+                const VectorRegister distSquared = VectorMultiplyAdd(dx, dx, VectorMultiply(dy, dy));
+                const VectorRegister dist = VectorMultiply(distSquared, VectorReciprocalSqrtAccurate(VectorMax(distSquared, epsilon)));
+                score = VectorMultiplyAdd(dist, VectorSetFloat1(consideration.Weight), score);
+                break;
+            }
+            case EConsideration::Value:
+                score = VectorMultiplyAdd(VectorLoadAligned(&candidates.m_Values[i]), VectorSetFloat1(consideration.Weight), score);
+                break;
+            case EConsideration::RejectToward:
+            {
+                const VectorRegister dot = VectorMultiplyAdd(VectorLoadAligned(&candidates.m_DirectionX[i]), VectorSetFloat1(consideration.Vector.X),
+                    VectorMultiply(VectorLoadAligned(&candidates.m_DirectionY[i]), VectorSetFloat1(consideration.Vector.Y)));
+                accepted = VectorBitwiseAnd(accepted, VectorCompareGT(VectorSetFloat1(consideration.Threshold), dot));
+                break;
+            }
+            case EConsideration::Require:
+                accepted = VectorBitwiseAnd(accepted, VectorCompareGT(VectorLoadAligned(&candidates.m_Flags[consideration.Flag][i]), half));
+                break;
+            }
+        }
+
+        VectorStoreAligned(VectorSelect(accepted, score, rejectedScore), &m_Scores[i]);
+    }
+
+    for (const TPair<int32, float>& bonus : m_Bonuses)
+    {
+        if (bonus.Key >= 0 && bonus.Key < candidates.Num() && m_Scores[bonus.Key] != RejectedScore)
+            m_Scores[bonus.Key] += bonus.Value;
+    }
+}
+
+void FSDTUtilityScorer::SelectTopK(const FSDTUtilityCandidates& candidates, int32 k, TArray<int32>& outIndices, TArray<float>* outScores)
+{
+    outIndices.Reset();
+    if (outScores)
+        outScores->Reset();
+
+    if (k <= 0 || candidates.Num() == 0)
+        return;
+
+    Score(candidates);
+
+    // insertion in a short sorted list, k is small compared to the candidate count
+    TArray<float, TInlineAllocator<16>> bestScores;
+    for (int32 i = 0; i < candidates.Num(); ++i)
+    {
+        const float score = m_Scores[i];
+        if (score == RejectedScore || (bestScores.Num() == k && score <= bestScores.Last()))
+            continue;
+
+        int32 insertIndex = bestScores.Num();
+        while (insertIndex > 0 && bestScores[insertIndex - 1] < score)
+        {
+            --insertIndex;
+        }
+        bestScores.Insert(score, insertIndex);
+        outIndices.Insert(i, insertIndex);
+        if (bestScores.Num() > k)
+        {
+            bestScores.Pop(false);
+            outIndices.Pop(false);
+        }
+    }
+
+    if (outScores)
+        outScores->Append(bestScores.GetData(), bestScores.Num());
+}
+
+namespace
+{
+    /*
+     * Compares the scorer with the loops it replaced, on random candidates:
+     * the nearest reachable collectible by path length, and the two flee locations furthest from the threat whose route does not head toward it
+     */
+    void RunBenchmark(const TArray<FString>& args)
+    {
+        const int32 candidateCount = args.Num() > 0 ? FMath::Max(1, FCString::Atoi(*args[0])) : 256;
+        const int32 iterationCount = args.Num() > 1 ? FMath::Max(1, FCString::Atoi(*args[1])) : 1000;
+        const float maxThreatAngle = 45.f;
+
+        FRandomStream random(1);
+        const FVector2D agentLocation = FVector2D::ZeroVector;
+        const FVector2D threatLocation(random.FRandRange(-2000.f, 2000.f), random.FRandRange(-2000.f, 2000.f));
+        const FVector2D toThreat = (threatLocation - agentLocation).GetSafeNormal();
+
+        TArray<FVector2D> locations;
+        TArray<FVector2D> directions;
+        TArray<float> pathLengths;
+        TArray<bool> available;
+        TArray<bool> unreserved;
+        FSDTUtilityCandidates candidates;
+        candidates.Reset(candidateCount);
+
+        for (int32 i = 0; i < candidateCount; ++i)
+        {
+            locations.Add(FVector2D(random.FRandRange(-5000.f, 5000.f), random.FRandRange(-5000.f, 5000.f)));
+            directions.Add(FVector2D(random.GetUnitVector()).GetSafeNormal());
+            pathLengths.Add(locations[i].Size() * random.FRandRange(1.f, 1.5f));
+            available.Add(random.FRand() < 0.9f);
+            unreserved.Add(random.FRand() < 0.8f);
+
+            candidates.SetLocation(i, locations[i]);
+            candidates.SetDirection(i, directions[i]);
+            candidates.SetValue(i, pathLengths[i]);
+            candidates.SetFlag(i, FSDTUtilityCandidates::Available, available[i]);
+            candidates.SetFlag(i, FSDTUtilityCandidates::Unreserved, unreserved[i]);
+        }
+
+        int32 mismatchCount = 0;
+        TArray<int32> scorerIndices;
+
+        // nearest collectible
+        int32 loopNearest = INDEX_NONE;
+        double startTime = FPlatformTime::Seconds();
+        for (int32 iteration = 0; iteration < iterationCount; ++iteration)
+        {
+            float minDistance = MAX_FLT;
+            loopNearest = INDEX_NONE;
+            for (int32 i = 0; i < candidateCount; ++i)
+            {
+                if (available[i] && unreserved[i] && pathLengths[i] < minDistance)
+                {
+                    loopNearest = i;
+                    minDistance = pathLengths[i];
+                }
+            }
+        }
+        const double loopNearestMs = (FPlatformTime::Seconds() - startTime) * 1000.0 / iterationCount;
+
+        startTime = FPlatformTime::Seconds();
+        for (int32 iteration = 0; iteration < iterationCount; ++iteration)
+        {
+            FSDTUtilityScorer scorer;
+            scorer.AddValue(-1.f).Require(FSDTUtilityCandidates::Available).Require(FSDTUtilityCandidates::Unreserved);
+            scorer.SelectTopK(candidates, 1, scorerIndices);
+        }
+        const double scorerNearestMs = (FPlatformTime::Seconds() - startTime) * 1000.0 / iterationCount;
+        mismatchCount += (scorerIndices.Num() > 0 ? scorerIndices[0] : INDEX_NONE) != loopNearest;
+
+        // flee locations
+        TArray<int32> loopFlee;
+        startTime = FPlatformTime::Seconds();
+        for (int32 iteration = 0; iteration < iterationCount; ++iteration)
+        {
+            loopFlee.Reset();
+            for (int32 i = 0; i < candidateCount; ++i)
+            {
+                const bool routeCrossesThreat = FMath::RadiansToDegrees(std::acos(FVector2D::DotProduct(directions[i], toThreat))) <= maxThreatAngle;
+                if (available[i] && !routeCrossesThreat)
+                    loopFlee.Add(i);
+            }
+            loopFlee.Sort([&](int32 index1, int32 index2) {
+                return FVector2D::DistSquared(threatLocation, locations[index1]) > FVector2D::DistSquared(threatLocation, locations[index2]);
+            });
+            loopFlee.SetNum(FMath::Min(loopFlee.Num(), 2), false);
+        }
+        const double loopFleeMs = (FPlatformTime::Seconds() - startTime) * 1000.0 / iterationCount;
+
+        startTime = FPlatformTime::Seconds();
+        for (int32 iteration = 0; iteration < iterationCount; ++iteration)
+        {
+            FSDTUtilityScorer scorer;
+            scorer.PreferFar(threatLocation).RejectToward(toThreat, maxThreatAngle).Require(FSDTUtilityCandidates::Available);
+            scorer.SelectTopK(candidates, 2, scorerIndices);
+        }
+        const double scorerFleeMs = (FPlatformTime::Seconds() - startTime) * 1000.0 / iterationCount;
+        mismatchCount += scorerIndices != loopFlee;
+
+        UE_LOG(LogSoftDesignTraining, Log, TEXT("Utility scorer benchmark, %d candidates, %d iterations:"), candidateCount, iterationCount);
+        UE_LOG(LogSoftDesignTraining, Log, TEXT("  nearest collectible: loop %.4f ms, scorer %.4f ms"), loopNearestMs, scorerNearestMs);
+        UE_LOG(LogSoftDesignTraining, Log, TEXT("  flee locations:      loop %.4f ms, scorer %.4f ms"), loopFleeMs, scorerFleeMs);
+        if (mismatchCount > 0)
+            UE_LOG(LogSoftDesignTraining, Warning, TEXT("  %d selections differ between the loops and the scorer"), mismatchCount);
+    }
+}
@@ -0,0 +1,91 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Candidate targets of a utility evaluation.
+ * Components are stored in separate arrays padded to a multiple of 4, so the scorer evaluates 4 candidates per SIMD operation.
+ */
+class SOFTDESIGNTRAINING_API FSDTUtilityCandidates
+{
+public:
+    // Flags the considerations can require, all of them are set by default
+    enum EFlag : uint8
+    {
+        // The candidate is not collected nor on cooldown
+        Available,
+        // The candidate is not claimed by another agent
+        Unreserved,
+        FlagCount
+    };
+
+    void Reset(int32 count);
+    int32 Num() const { return m_Count; }
+
+    void SetLocation(int32 index, const FVector2D& location) { m_X[index] = location.X; m_Y[index] = location.Y; }
+    void SetDirection(int32 index, const FVector2D& direction) { m_DirectionX[index] = direction.X; m_DirectionY[index] = direction.Y; }
+    void SetValue(int32 index, float value) { m_Values[index] = value; }
+    void SetFlag(int32 index, EFlag flag, bool set) { m_Flags[flag][index] = set ? 1.f : 0.f; }
+
+private:
+    friend class FSDTUtilityScorer;
+    typedef TArray<float, TAlignedHeapAllocator<16>> FAlignedFloats;
+
+    int32 m_Count = 0;
+    FAlignedFloats m_X, m_Y;
+    FAlignedFloats m_DirectionX, m_DirectionY;
+    FAlignedFloats m_Values;
+    FAlignedFloats m_Flags[FlagCount];
+};
+
+/**
+ * Scores candidates with a sum of weighted considerations, some of them rejecting candidates outright, and keeps the best ones.
+ * A scorer is cheap to build and is meant to be used by a single thread: build one per agent and evaluation.
+ */
+class SOFTDESIGNTRAINING_API FSDTUtilityScorer
+{
+public:
+    // Adds -weight * the 2D distance between the candidate and the point
+    FSDTUtilityScorer& PreferNear(const FVector2D& point, float weight = 1.f);
+    // Adds weight * the 2D distance between the candidate and the point
+    FSDTUtilityScorer& PreferFar(const FVector2D& point, float weight = 1.f);
+    // Adds weight * the value of the candidate
+    FSDTUtilityScorer& AddValue(float weight = 1.f);
+    // Adds a bonus to a single candidate
+    FSDTUtilityScorer& AddBonus(int32 index, float bonus);
+    // Rejects the candidates whose direction is within maxAngle degrees of the direction, both being unit vectors
+    FSDTUtilityScorer& RejectToward(const FVector2D& direction, float maxAngle);
+    // Rejects the candidates without the flag
+    FSDTUtilityScorer& Require(FSDTUtilityCandidates::EFlag flag);
+
+    void Reset();
+
+    // Writes the indices of the k best candidates that were not rejected, the best first. Ties go to the lowest index.
+    void SelectTopK(const FSDTUtilityCandidates& candidates, int32 k, TArray<int32>& outIndices, TArray<float>* outScores = nullptr);
+
+private:
+    void Score(const FSDTUtilityCandidates& candidates);
+
+    enum class EConsideration : uint8
+    {
+        Distance,
+        Value,
+        RejectToward,
+        Require,
+    };
+
+    struct FConsideration
+    {
+        EConsideration Type;
+        float Weight;
+        FVector2D Vector;
+        float Threshold;
+        int32 Flag;
+    };
+    TArray<FConsideration, TInlineAllocator<8>> m_Considerations;
+    TArray<TPair<int32, float>, TInlineAllocator<4>> m_Bonuses;
+
+    TArray<float, TAlignedHeapAllocator<16>> m_Scores;
+};
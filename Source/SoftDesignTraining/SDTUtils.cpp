@@ -2,24 +2,470 @@
 
 #include "SDTUtils.h"
 #include "SoftDesignTraining.h"
+#include "SDTStats.h"
+#include "SDTWorldSnapshot.h"
 #include "SoftDesignTrainingMainCharacter.h"
 #include "DrawDebugHelpers.h"
 #include "Engine/World.h"
+#include "Misc/ScopeRWLock.h"
+
+namespace
+{
+    TAutoConsoleVariable<int32> CVarLOSCache(
+        TEXT("sdt.LOSCache"),
+        0,
+        TEXT("Caches the results of SDTUtils::Raycast.\n")
+        TEXT(" 0: off\n")
+        TEXT(" 1: on"),
+        ECVF_Default);
+
+    TAutoConsoleVariable<float> CVarLOSCacheCellSize(
+        TEXT("sdt.LOSCache.CellSize"),
+        50.f,
+        TEXT("Size of the cells the source and target points are quantized to, in world units."),
+        ECVF_Default);
+
+    TAutoConsoleVariable<int32> CVarLOSCacheTTL(
+        TEXT("sdt.LOSCache.TTL"),
+        10,
+        TEXT("Number of frames a cached line of sight stays valid."),
+        ECVF_Default);
+
+    TAutoConsoleVariable<int32> CVarLOSCacheMaxEntries(
+        TEXT("sdt.LOSCache.MaxEntries"),
+        16384,
+        TEXT("Number of cached lines of sight above which expired entries are evicted."),
+        ECVF_Default);
+
+    TAutoConsoleVariable<float> CVarLOSCacheBlockerCellSize(
+        TEXT("sdt.LOSCache.BlockerCellSize"),
+        200.f,
+        TEXT("Size of the cells in which the moves of the movable blockers are recorded, in world units."),
+        ECVF_Default);
+
+    /*
+     * Line of sight results keyed by the quantized source and target points.
+     * An entry is evicted when it gets older than the TTL, or when a movable blocker moved in one of the cells crossed by its line.
+     * The movable components are tracked once they have blocked a line of sight, or once they overlap the cells around a line cached
+     * as visible: their moves are sampled once per frame on the game thread and recorded per cell, so queries only read plain data
+     * and can come from any thread. A blocker coming from further than half a cell away within the TTL is only covered by the TTL.
+     */
+    class FLOSCache
+    {
+    public:
+        struct FKey
+        {
+            const UWorld* World;
+            FIntVector Source;
+            FIntVector Target;
+
+            bool operator==(const FKey& other) const { return World == other.World && Source == other.Source && Target == other.Target; }
+            friend uint32 GetTypeHash(const FKey& key) { return HashCombine(HashCombine(PointerHash(key.World), GetTypeHash(key.Source)), GetTypeHash(key.Target)); }
+        };
+
+        bool Find(const FKey& key, uint64 frame, bool& outBlocked)
+        {
+            bool expired = false;
+            {
+                FRWScopeLock lock(m_Lock, SLT_ReadOnly);
+                if (const FEntry* entry = m_Entries.Find(key))
+                {
+                    expired = !IsValid(key, *entry, frame);
+                    if (!expired)
+                    {
+                        outBlocked = entry->Blocked;
+                        m_Hits.Increment();
+                        SDT_INC_COUNTER_STAT(LOSCacheHits, 1);
+                        return true;
+                    }
+                }
+            }
+
+            if (expired)
+            {
+                FRWScopeLock lock(m_Lock, SLT_Write);
+                const int32 evictionCount = m_Entries.Remove(key);
+                m_Evictions.Add(evictionCount);
+                SDT_INC_COUNTER_STAT(LOSCacheEvictions, evictionCount);
+            }
+            m_Misses.Increment();
+            SDT_INC_COUNTER_STAT(LOSCacheMisses, 1);
+            return false;
+        }
+
+        void Add(const FKey& key, uint64 frame, const FVector& source, const FVector& target, const FHitResult& hitData)
+        {
+            FEntry entry;
+            entry.Frame = frame;
+            entry.Blocked = hitData.bBlockingHit;
+            entry.Source = source;
+            entry.Target = target;
+
+            FRWScopeLock lock(m_Lock, SLT_Write);
+
+            // the blocker is only resolved on the game thread, where its mobility is checked
+            if (entry.Blocked && !hitData.Component.IsExplicitlyNull())
+                m_PendingBlockers.Add(hitData.Component);
+            // the movable components around a visible line are only looked up on the game thread
+            else if (!entry.Blocked)
+                m_PendingLines.Add({ key.World, frame, source, target });
+
+            if (m_Entries.Num() >= CVarLOSCacheMaxEntries.GetValueOnAnyThread())
+                EvictExpired(frame);
+
+            m_Entries.Add(key, entry);
+        }
+
+        void Register()
+        {
+            m_PreActorTickHandle = FWorldDelegates::OnWorldPreActorTick.AddRaw(this, &FLOSCache::OnWorldPreActorTick);
+        }
+
+        void Unregister()
+        {
+            FWorldDelegates::OnWorldPreActorTick.Remove(m_PreActorTickHandle);
+            m_PreActorTickHandle.Reset();
+        }
+
+        /*
+         * Game thread only: samples the movable blockers of the world and records the cells they moved in during the last frame
+         */
+        void Update(const UWorld* world, uint64 frame)
+        {
+            TSet<TWeakObjectPtr<UPrimitiveComponent>> pendingBlockers;
+            TArray<FLine> pendingLines;
+            {
+                FRWScopeLock lock(m_Lock, SLT_Write);
+                pendingBlockers = MoveTemp(m_PendingBlockers);
+                m_PendingBlockers.Reset();
+                pendingLines = MoveTemp(m_PendingLines);
+                m_PendingLines.Reset();
+            }
+
+            for (const TWeakObjectPtr<UPrimitiveComponent>& pendingBlocker : pendingBlockers)
+                TrackBlocker(pendingBlocker.Get());
+
+            const float cellSize = FMath::Max(CVarLOSCacheBlockerCellSize.GetValueOnGameThread(), 1.f);
+            TrackBlockersAroundLines(world, pendingLines, cellSize, frame);
+
+            TArray<FBox, TInlineAllocator<16>> movedBoxes;
+            for (auto it = m_Blockers.CreateIterator(); it; ++it)
+            {
+                FBlocker& tracked = it.Value();
+
+                // a destroyed blocker no longer blocks anything
+                const UPrimitiveComponent* blocker = it.Key().Get();
+                if (!blocker)
+                {
+                    if (tracked.World == world)
+                        movedBoxes.Add(tracked.Bounds);
+                    it.RemoveCurrent();
+                    continue;
+                }
+
+                if (tracked.World != world)
+                    continue;
+
+                const FBox bounds = blocker->Bounds.GetBox();
+                if (FVector::DistSquared(bounds.GetCenter(), tracked.Bounds.GetCenter()) > FMath::Square(cellSize * 0.25f) || !bounds.GetExtent().Equals(tracked.Bounds.GetExtent(), 1.f))
+                {
+                    movedBoxes.Add(tracked.Bounds);
+                    movedBoxes.Add(bounds);
+                    tracked.Bounds = bounds;
+                }
+            }
+
+            if (movedBoxes.Num() == 0)
+                return;
+
+            FRWScopeLock lock(m_Lock, SLT_Write);
+            m_BlockerCellSize = cellSize;
+            for (const FBox& box : movedBoxes)
+            {
+                // expanded by half a cell, the lines are sampled every half cell
+                const FIntPoint minCell = GetBlockerCell(box.Min - FVector(cellSize * 0.5f), cellSize);
+                const FIntPoint maxCell = GetBlockerCell(box.Max + FVector(cellSize * 0.5f), cellSize);
+                for (int32 y = minCell.Y; y <= maxCell.Y; ++y)
+                {
+                    for (int32 x = minCell.X; x <= maxCell.X; ++x)
+                    {
+                        m_BlockerMoveFrames.Add({ world, FIntPoint(x, y) }, frame);
+                    }
+                }
+            }
+        }
+
+        void Flush()
+        {
+            FRWScopeLock lock(m_Lock, SLT_Write);
+            m_Evictions.Add(m_Entries.Num());
+            SDT_INC_COUNTER_STAT(LOSCacheEvictions, m_Entries.Num());
+            m_Entries.Reset();
+        }
+
+        SDTUtils::LOSCacheStats GetStats()
+        {
+            FRWScopeLock lock(m_Lock, SLT_ReadOnly);
+            return { m_Hits.GetValue(), m_Misses.GetValue(), m_Evictions.GetValue(), m_Entries.Num() };
+        }
+
+    private:
+        struct FEntry
+        {
+            uint64 Frame = 0;
+            bool Blocked = false;
+            FVector Source = FVector::ZeroVector;
+            FVector Target = FVector::ZeroVector;
+        };
+
+        struct FBlocker
+        {
+            const UWorld* World;
+            FBox Bounds;
+        };
+
+        struct FCellKey
+        {
+            const UWorld* World;
+            FIntPoint Cell;
+
+            bool operator==(const FCellKey& other) const { return World == other.World && Cell == other.Cell; }
+            friend uint32 GetTypeHash(const FCellKey& key) { return HashCombine(PointerHash(key.World), GetTypeHash(key.Cell)); }
+        };
+
+        struct FLine
+        {
+            const UWorld* World;
+            uint64 Frame;
+            FVector Source;
+            FVector Target;
+        };
+
+        static FIntPoint GetBlockerCell(const FVector& location, float cellSize)
+        {
+            return FIntPoint(FMath::FloorToInt(location.X / cellSize), FMath::FloorToInt(location.Y / cellSize));
+        }
+
+        void OnWorldPreActorTick(UWorld* world, ELevelTick tickType, float deltaSeconds)
+        {
+            // the cached lines of sight crossed by a moving blocker are invalidated before this frame's queries
+            if (world->IsGameWorld())
+                Update(world, GFrameCounter);
+        }
+
+        void TrackBlocker(UPrimitiveComponent* blocker)
+        {
+            if (blocker && blocker->Mobility == EComponentMobility::Movable && !m_Blockers.Contains(blocker))
+                m_Blockers.Add(blocker, { blocker->GetWorld(), blocker->Bounds.GetBox() });
+        }
+
+        /*
+         * Looks up the movable components overlapping the cells crossed by the lines newly cached as visible, so that they invalidate
+         * these lines when they move. A cell is looked up again once the entries it was looked up for are expired.
+         */
+        void TrackBlockersAroundLines(const UWorld* world, const TArray<FLine>& lines, float cellSize, uint64 frame)
+        {
+            const uint64 ttl = uint64(CVarLOSCacheTTL.GetValueOnGameThread());
+            for (auto it = m_LookedUpCells.CreateIterator(); it; ++it)
+            {
+                if (frame - it.Value() > ttl)
+                    it.RemoveCurrent();
+            }
+
+            TArray<FVector, TInlineAllocator<64>> cellCenters;
+            TArray<FLine> otherWorldLines;
+            for (const FLine& line : lines)
+            {
+                // the lines cached for another world wait for its own tick, unless they are already expired
+                if (line.World != world)
+                {
+                    if (frame - line.Frame <= ttl)
+                        otherWorldLines.Add(line);
+                    continue;
+                }
+
+                const float length = FVector::Dist2D(line.Source, line.Target);
+                const int32 sampleCount = FMath::CeilToInt(length / (cellSize * 0.5f)) + 1;
+                for (int32 i = 0; i < sampleCount; ++i)
+                {
+                    const float alpha = sampleCount > 1 ? float(i) / (sampleCount - 1) : 0.f;
+                    const FVector sample = FMath::Lerp(line.Source, line.Target, alpha);
+                    const FIntPoint cell = GetBlockerCell(sample, cellSize);
+                    if (m_LookedUpCells.Contains({ world, cell }))
+                        continue;
+
+                    m_LookedUpCells.Add({ world, cell }, frame);
+                    cellCenters.Add(FVector((cell.X + 0.5f) * cellSize, (cell.Y + 0.5f) * cellSize, sample.Z));
+                }
+            }
+
+            if (otherWorldLines.Num() > 0)
+            {
+                FRWScopeLock lock(m_Lock, SLT_Write);
+                m_PendingLines.Append(otherWorldLines);
+            }
+
+            // the cell expanded by half a cell, as the moves are recorded
+            const FCollisionShape cellShape = FCollisionShape::MakeBox(FVector(cellSize));
+            const FCollisionQueryParams queryParams = SDTUtils::GetLineOfSightParams();
+            TArray<FOverlapResult> overlaps;
+            for (const FVector& cellCenter : cellCenters)
+            {
+                SDT_INC_COUNTER_STAT(LOSCacheBlockerLookups, 1);
+                overlaps.Reset();
+                world->OverlapMultiByChannel(overlaps, cellCenter, FQuat::Identity, COLLISION_LINE_OF_SIGHT, cellShape, queryParams);
+                for (const FOverlapResult& overlap : overlaps)
+                    TrackBlocker(overlap.GetComponent());
+            }
+        }
+
+        bool IsValid(const FKey& key, const FEntry& entry, uint64 frame) const
+        {
+            if (frame - entry.Frame > uint64(CVarLOSCacheTTL.GetValueOnAnyThread()))
+                return false;
+
+            if (m_BlockerMoveFrames.Num() == 0)
+                return true;
+
+            // a blocker moved across the line after it was traced
+            const float length = FVector::Dist2D(entry.Source, entry.Target);
+            const int32 sampleCount = FMath::CeilToInt(length / (m_BlockerCellSize * 0.5f)) + 1;
+            for (int32 i = 0; i < sampleCount; ++i)
+            {
+                const float alpha = sampleCount > 1 ? float(i) / (sampleCount - 1) : 0.f;
+                const uint64* moveFrame = m_BlockerMoveFrames.Find({ key.World, GetBlockerCell(FMath::Lerp(entry.Source, entry.Target, alpha), m_BlockerCellSize) });
+                if (moveFrame && *moveFrame > entry.Frame)
+                    return false;
+            }
+            return true;
+        }
+
+        void EvictExpired(uint64 frame)
+        {
+            const int32 previousCount = m_Entries.Num();
+            for (auto it = m_Entries.CreateIterator(); it; ++it)
+            {
+                if (!IsValid(it.Key(), it.Value(), frame))
+                    it.RemoveCurrent();
+            }
+
+            // everything is still fresh, start over rather than growing without bounds
+            if (m_Entries.Num() == previousCount)
+                m_Entries.Reset();
+
+            m_Evictions.Add(previousCount - m_Entries.Num());
+            SDT_INC_COUNTER_STAT(LOSCacheEvictions, previousCount - m_Entries.Num());
+        }
+
+        FRWLock m_Lock;
+        TMap<FKey, FEntry> m_Entries;
+        FThreadSafeCounter m_Hits;
+        FThreadSafeCounter m_Misses;
+        FThreadSafeCounter m_Evictions;
+
+        // Written under the lock by the game thread, read by the queries
+        TMap<FCellKey, uint64> m_BlockerMoveFrames;
+        float m_BlockerCellSize = 200.f;
+
+        // Blockers found by the queries and lines cached as visible, waiting to be checked on the game thread
+        TSet<TWeakObjectPtr<UPrimitiveComponent>> m_PendingBlockers;
+        TArray<FLine> m_PendingLines;
+
+        // Game thread only
+        TMap<TWeakObjectPtr<UPrimitiveComponent>, FBlocker> m_Blockers;
+        TMap<FCellKey, uint64> m_LookedUpCells;
+        FDelegateHandle m_PreActorTickHandle;
+    };
+
+    FLOSCache GLOSCache;
+
+    FIntVector QuantizeLOSPoint(const FVector& point, float cellSize)
+    {
+        return FIntVector(FMath::FloorToInt(point.X / cellSize), FMath::FloorToInt(point.Y / cellSize), FMath::FloorToInt(point.Z / cellSize));
+    }
+
+    FAutoConsoleCommand LOSCacheStatsCommand(
+        TEXT("sdt.LOSCache.Stats"),
+        TEXT("Logs the hit, miss and eviction counts of the line of sight cache."),
+        FConsoleCommandDelegate::CreateLambda([]() {
+            const SDTUtils::LOSCacheStats stats = SDTUtils::GetLOSCacheStats();
+            UE_LOG(LogSoftDesignTraining, Log, TEXT("LOS cache: %d hits, %d misses, %d evictions, %d entries"), stats.Hits, stats.Misses, stats.Evictions, stats.Entries);
+        }));
+
+    FAutoConsoleCommand LOSCacheFlushCommand(
+        TEXT("sdt.LOSCache.Flush"),
+        TEXT("Evicts all the entries of the line of sight cache."),
+        FConsoleCommandDelegate::CreateStatic(&SDTUtils::FlushLOSCache));
+}
 
 /*static*/ bool SDTUtils::Raycast(UWorld* uWorld, FVector sourcePoint, FVector targetPoint)
 {
+    SDT_SCOPE_CYCLE_STAT(Raycast);
+
+    const bool useCache = CVarLOSCache.GetValueOnAnyThread() != 0;
+    const uint64 frame = GFrameCounter;
+
+    FLOSCache::FKey cacheKey;
+    if (useCache)
+    {
+        const float cellSize = FMath::Max(CVarLOSCacheCellSize.GetValueOnAnyThread(), 1.f);
+        cacheKey = { uWorld, QuantizeLOSPoint(sourcePoint, cellSize), QuantizeLOSPoint(targetPoint, cellSize) };
+
+        bool blocked;
+        if (GLOSCache.Find(cacheKey, frame, blocked))
+            return blocked;
+    }
+
     FHitResult hitData;
-    FCollisionQueryParams TraceParams(FName(TEXT("VictoreCore Trace")), true);
     
     // Fake cost for the exercise
     //Sleep(1);
     // End fake cost
 
-    return uWorld->LineTraceSingleByChannel(hitData, sourcePoint, targetPoint, ECC_Pawn, TraceParams);
+    SDT_INC_COUNTER_STAT(Traces, 1);
+    const bool blocked = uWorld->LineTraceSingleByChannel(hitData, sourcePoint, targetPoint, COLLISION_LINE_OF_SIGHT, GetLineOfSightParams());
+
+    if (useCache)
+        GLOSCache.Add(cacheKey, frame, sourcePoint, targetPoint, hitData);
+
+    return blocked;
+}
+
+FCollisionQueryParams SDTUtils::GetLineOfSightParams()
+{
+    return FCollisionQueryParams(FName(TEXT("VictoreCore Trace")), true);
+}
+
+void SDTUtils::RegisterLOSCache()
+{
+    GLOSCache.Register();
+}
+
+void SDTUtils::UnregisterLOSCache()
+{
+    GLOSCache.Unregister();
+}
+
+SDTUtils::LOSCacheStats SDTUtils::GetLOSCacheStats()
+{
+    return GLOSCache.GetStats();
+}
+
+void SDTUtils::FlushLOSCache()
+{
+    GLOSCache.Flush();
 }
 
 bool SDTUtils::IsPlayerPoweredUp(UWorld * uWorld)
 {
+    SDT_SCOPE_CYCLE_STAT(IsPlayerPoweredUp);
+
+    if (const USDTWorldSnapshotSubsystem* snapshots = uWorld->GetSubsystem<USDTWorldSnapshotSubsystem>())
+    {
+        if (FSDTWorldSnapshotPtr snapshot = snapshots->GetSnapshot())
+            return snapshot->PlayerPoweredUp;
+    }
+
     ACharacter* playerCharacter = UGameplayStatics::GetPlayerCharacter(uWorld, 0);
     if (!playerCharacter)
         return false;
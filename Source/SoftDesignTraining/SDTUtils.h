@@ -8,13 +8,34 @@
 #define COLLISION_DEATH_OBJECT		ECollisionChannel::ECC_GameTraceChannel3
 #define COLLISION_PLAYER        	ECollisionChannel::ECC_GameTraceChannel4
 #define COLLISION_COLLECTIBLE     	ECollisionChannel::ECC_GameTraceChannel5
+#define COLLISION_LINE_OF_SIGHT    	ECollisionChannel::ECC_Pawn
+
+struct FCollisionQueryParams;
 
 class SOFTDESIGNTRAINING_API SDTUtils
 {
 public:
     static bool Raycast(UWorld* uWorld, FVector sourcePoint, FVector targetPoint);
+
+    // Query params of the line of sight traces, traced on COLLISION_LINE_OF_SIGHT
+    static FCollisionQueryParams GetLineOfSightParams();
     static bool IsPlayerPoweredUp(UWorld* uWorld);
 
+    // Line of sight cache used by Raycast when sdt.LOSCache is enabled
+    struct LOSCacheStats
+    {
+        int32 Hits;
+        int32 Misses;
+        int32 Evictions;
+        int32 Entries;
+    };
+    static LOSCacheStats GetLOSCacheStats();
+    static void FlushLOSCache();
+
+    // Hooks the cache to the world ticks, where the movable blockers of the cached lines of sight are sampled once per frame
+    static void RegisterLOSCache();
+    static void UnregisterLOSCache();
+
     enum NavType
     {
         Default,
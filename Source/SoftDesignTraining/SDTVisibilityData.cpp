@@ -0,0 +1,15 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "SDTVisibilityData.h"
+#include "SoftDesignTraining.h"
+
+/*
+ * Index of the pair in the upper triangle of the walkable cells matrix, the diagonal excluded
+ */
+int32 USDTVisibilityData::GetPairIndex(int32 walkableIndex1, int32 walkableIndex2, int32 walkableCount)
+{
+    const int64 i = FMath::Min(walkableIndex1, walkableIndex2);
+    const int64 j = FMath::Max(walkableIndex1, walkableIndex2);
+
+    return int32(i * walkableCount - i * (i + 1) / 2 + (j - i - 1));
+}
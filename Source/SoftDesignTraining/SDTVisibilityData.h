@@ -0,0 +1,51 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+#include "SDTVisibilityData.generated.h"
+
+/**
+ * Cell to cell visibility of the static geometry of a level, baked by the SDTBakeVisibility commandlet.
+ * Only the walkable cells are kept and each pair of them is stored once, as two compressed bitsets:
+ * whether the cells see each other and whether the answer is ambiguous (some of the traces between them were blocked).
+ */
+UCLASS()
+class SOFTDESIGNTRAINING_API USDTVisibilityData : public UDataAsset
+{
+    GENERATED_BODY()
+
+public:
+    static int32 GetPairIndex(int32 walkableIndex1, int32 walkableIndex2, int32 walkableCount);
+    static int64 GetPairCount(int32 walkableCount) { return int64(walkableCount) * (walkableCount - 1) / 2; }
+
+    // The pairs are indexed with int32, which limits the number of walkable cells to about 65k
+    static bool IsWalkableCountSupported(int32 walkableCount) { return GetPairCount(walkableCount) <= MAX_int32; }
+
+    UPROPERTY(VisibleAnywhere, Category = Visibility)
+    FVector2D m_Origin;
+
+    UPROPERTY(VisibleAnywhere, Category = Visibility)
+    float m_CellSize = 0.f;
+
+    UPROPERTY(VisibleAnywhere, Category = Visibility)
+    FIntPoint m_GridSize;
+
+    // Index of every grid cell among the walkable ones, INDEX_NONE when not walkable
+    UPROPERTY()
+    TArray<int32> m_WalkableIndices;
+
+    UPROPERTY(VisibleAnywhere, Category = Visibility)
+    int32 m_WalkableCount = 0;
+
+    // Size of each bitset once uncompressed, in bytes
+    UPROPERTY(VisibleAnywhere, Category = Visibility)
+    int32 m_BitsetSize = 0;
+
+    UPROPERTY()
+    TArray<uint8> m_CompressedVisibleBits;
+
+    UPROPERTY()
+    TArray<uint8> m_CompressedAmbiguousBits;
+};
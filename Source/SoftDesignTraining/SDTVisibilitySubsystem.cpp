@@ -0,0 +1,117 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "SDTVisibilitySubsystem.h"
+#include "SoftDesignTraining.h"
+#include "SDTUtils.h"
+#include "SDTVisibilityData.h"
+#include "Misc/PackageName.h"
+#include "Misc/Compression.h"
+
+static TAutoConsoleVariable<int32> CVarStaticVisibility(
+    TEXT("sdt.StaticVisibility"),
+    2,
+    TEXT("Use the visibility baked by the SDTBakeVisibility commandlet before tracing.\n")
+    TEXT(" 0: always trace\n")
+    TEXT(" 1: trust the baked visible and blocked answers\n")
+    TEXT(" 2: trust the baked blocked answers, trace the visible ones for dynamic occluders"),
+    ECVF_Default);
+
+void USDTVisibilitySubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+    Super::Initialize(Collection);
+
+    UWorld* world = GetWorld();
+    if (!world || !world->IsGameWorld())
+        return;
+
+    const FString objectPath = GetVisibilityDataPackageName(*world) + TEXT(".") + GetVisibilityDataName(*world);
+    m_Data = LoadObject<USDTVisibilityData>(nullptr, *objectPath, nullptr, LOAD_NoWarn | LOAD_Quiet);
+    if (!m_Data)
+        return;
+
+    if (!USDTVisibilityData::IsWalkableCountSupported(m_Data->m_WalkableCount))
+    {
+        UE_LOG(LogSoftDesignTraining, Warning, TEXT("The visibility data %s has too many walkable cells (%d)"), *objectPath, m_Data->m_WalkableCount);
+        m_Data = nullptr;
+        return;
+    }
+
+    m_VisibleBits.SetNumUninitialized(m_Data->m_BitsetSize);
+    m_AmbiguousBits.SetNumUninitialized(m_Data->m_BitsetSize);
+
+    const bool uncompressed =
+        FCompression::UncompressMemory(NAME_Zlib, m_VisibleBits.GetData(), m_Data->m_BitsetSize, m_Data->m_CompressedVisibleBits.GetData(), m_Data->m_CompressedVisibleBits.Num()) &&
+        FCompression::UncompressMemory(NAME_Zlib, m_AmbiguousBits.GetData(), m_Data->m_BitsetSize, m_Data->m_CompressedAmbiguousBits.GetData(), m_Data->m_CompressedAmbiguousBits.Num());
+
+    if (!uncompressed)
+    {
+        UE_LOG(LogSoftDesignTraining, Warning, TEXT("Could not uncompress the visibility data %s"), *objectPath);
+        m_Data = nullptr;
+    }
+}
+
+ESDTStaticVisibility USDTVisibilitySubsystem::Query(const FVector& from, const FVector& to) const
+{
+    if (!m_Data)
+        return ESDTStaticVisibility::Unknown;
+
+    const int32 fromIndex = GetWalkableIndex(from);
+    const int32 toIndex = GetWalkableIndex(to);
+
+    // a cell may be split by a wall, so locations in the same cell are left to the trace
+    if (fromIndex == INDEX_NONE || toIndex == INDEX_NONE || fromIndex == toIndex)
+        return ESDTStaticVisibility::Unknown;
+
+    const int32 pairIndex = USDTVisibilityData::GetPairIndex(fromIndex, toIndex, m_Data->m_WalkableCount);
+    const uint8 pairMask = 1 << (pairIndex % 8);
+
+    if (m_AmbiguousBits[pairIndex / 8] & pairMask)
+        return ESDTStaticVisibility::Unknown;
+
+    return (m_VisibleBits[pairIndex / 8] & pairMask) ? ESDTStaticVisibility::Visible : ESDTStaticVisibility::Blocked;
+}
+
+ESDTStaticVisibility USDTVisibilitySubsystem::QueryLineOfSight(const FVector& from, const FVector& to) const
+{
+    const int32 staticVisibilityMode = CVarStaticVisibility.GetValueOnAnyThread();
+    if (staticVisibilityMode == 0)
+        return ESDTStaticVisibility::Unknown;
+
+    const ESDTStaticVisibility staticVisibility = Query(from, to);
+
+    // dynamic occluders may still hide a target the static geometry does not
+    if (staticVisibility == ESDTStaticVisibility::Visible && staticVisibilityMode != 1)
+        return ESDTStaticVisibility::Unknown;
+
+    return staticVisibility;
+}
+
+bool USDTVisibilitySubsystem::IsVisible(UWorld* world, const FVector& from, const FVector& to)
+{
+    const USDTVisibilitySubsystem* visibility = world->GetSubsystem<USDTVisibilitySubsystem>();
+    const ESDTStaticVisibility staticVisibility = visibility ? visibility->QueryLineOfSight(from, to) : ESDTStaticVisibility::Unknown;
+    if (staticVisibility != ESDTStaticVisibility::Unknown)
+        return staticVisibility == ESDTStaticVisibility::Visible;
+
+    return !SDTUtils::Raycast(world, from, to);
+}
+
+int32 USDTVisibilitySubsystem::GetWalkableIndex(const FVector& location) const
+{
+    const int32 x = FMath::FloorToInt((location.X - m_Data->m_Origin.X) / m_Data->m_CellSize);
+    const int32 y = FMath::FloorToInt((location.Y - m_Data->m_Origin.Y) / m_Data->m_CellSize);
+    if (x < 0 || y < 0 || x >= m_Data->m_GridSize.X || y >= m_Data->m_GridSize.Y)
+        return INDEX_NONE;
+
+    return m_Data->m_WalkableIndices[y * m_Data->m_GridSize.X + x];
+}
+
+FString USDTVisibilitySubsystem::GetVisibilityDataName(const UWorld& world)
+{
+    return TEXT("PVS_") + UWorld::RemovePIEPrefix(FPackageName::GetShortName(world.GetOutermost()->GetName()));
+}
+
+FString USDTVisibilitySubsystem::GetVisibilityDataPackageName(const UWorld& world)
+{
+    return GetDefault<USDTVisibilitySubsystem>()->m_VisibilityDataPath / GetVisibilityDataName(world);
+}
@@ -0,0 +1,53 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "SDTVisibilitySubsystem.generated.h"
+
+class USDTVisibilityData;
+
+enum class ESDTStaticVisibility : uint8
+{
+    Visible,
+    Blocked,
+    Unknown,
+};
+
+/**
+ * Answers visibility queries from the static visibility baked for the current level, if any.
+ * Locations outside of the walkable cells and ambiguous pairs of cells are reported as unknown.
+ */
+UCLASS(config = Game)
+class SOFTDESIGNTRAINING_API USDTVisibilitySubsystem : public UWorldSubsystem
+{
+    GENERATED_BODY()
+
+public:
+    virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+
+    ESDTStaticVisibility Query(const FVector& from, const FVector& to) const;
+
+    // Baked answer as far as sdt.StaticVisibility trusts it, unknown when a line of sight trace still has to decide
+    ESDTStaticVisibility QueryLineOfSight(const FVector& from, const FVector& to) const;
+
+    // Line of sight from the baked answer when trusted, otherwise from SDTUtils::Raycast
+    static bool IsVisible(UWorld* world, const FVector& from, const FVector& to);
+
+    static FString GetVisibilityDataName(const UWorld& world);
+    static FString GetVisibilityDataPackageName(const UWorld& world);
+
+    // Content folder holding the baked visibility of the levels
+    UPROPERTY(config)
+    FString m_VisibilityDataPath = TEXT("/Game/Visibility");
+
+private:
+    int32 GetWalkableIndex(const FVector& location) const;
+
+    UPROPERTY()
+    USDTVisibilityData* m_Data;
+
+    TArray<uint8> m_VisibleBits;
+    TArray<uint8> m_AmbiguousBits;
+};
@@ -0,0 +1,125 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "SDTWorldSnapshot.h"
+#include "SoftDesignTraining.h"
+#include "SDTCollectible.h"
+#include "SDTCollectibleRegistry.h"
+#include "SDTFleeLocation.h"
+#include "SDTFleeTable.h"
+#include "SDTHazardSubsystem.h"
+#include "SDTStats.h"
+#include "SoftDesignTrainingMainCharacter.h"
+#include "Components/CapsuleComponent.h"
+#include "Engine/World.h"
+#include "Kismet/GameplayStatics.h"
+
+int32 FSDTWorldSnapshot::FindCollectibleSlot(const ASDTCollectible* collectible) const
+{
+    const int32* slot = CollectibleSlots.Find(collectible);
+    return slot ? *slot : INDEX_NONE;
+}
+
+bool FSDTWorldSnapshot::IsCollectibleAvailable(const ASDTCollectible* collectible) const
+{
+    const int32 slot = FindCollectibleSlot(collectible);
+    return slot != INDEX_NONE && CollectibleAvailable[slot];
+}
+
+void USDTWorldSnapshotSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+    Super::Initialize(Collection);
+
+    m_PreActorTickHandle = FWorldDelegates::OnWorldPreActorTick.AddUObject(this, &USDTWorldSnapshotSubsystem::OnWorldPreActorTick);
+}
+
+void USDTWorldSnapshotSubsystem::Deinitialize()
+{
+    FWorldDelegates::OnWorldPreActorTick.Remove(m_PreActorTickHandle);
+    m_Snapshot.Reset();
+    m_PreviousSnapshot.Reset();
+
+    Super::Deinitialize();
+}
+
+/*
+ * Publishes the snapshot of the new frame, filling the memory of the snapshot before the current one when nobody holds it anymore
+ */
+void USDTWorldSnapshotSubsystem::OnWorldPreActorTick(UWorld* world, ELevelTick tickType, float deltaSeconds)
+{
+    if (world != GetWorld() || !world->IsGameWorld())
+        return;
+
+    SDT_SCOPE_CYCLE_STAT(CaptureWorldSnapshot);
+
+    TSharedPtr<FSDTWorldSnapshot, ESPMode::ThreadSafe> snapshot = MoveTemp(m_PreviousSnapshot);
+    if (!snapshot.IsValid() || !snapshot.IsUnique())
+        snapshot = MakeShared<FSDTWorldSnapshot, ESPMode::ThreadSafe>();
+
+    Capture(*snapshot);
+
+    m_PreviousSnapshot = MoveTemp(m_Snapshot);
+    m_Snapshot = MoveTemp(snapshot);
+}
+
+void USDTWorldSnapshotSubsystem::Capture(FSDTWorldSnapshot& snapshot) const
+{
+    UWorld* world = GetWorld();
+    snapshot.Frame = GFrameCounter;
+    snapshot.Time = world->GetTimeSeconds();
+
+    snapshot.Player = nullptr;
+    snapshot.PlayerPoweredUp = false;
+    if (ACharacter* player = UGameplayStatics::GetPlayerCharacter(world, 0))
+    {
+        const UCapsuleComponent* playerCapsule = player->GetCapsuleComponent();
+        snapshot.Player = player;
+        snapshot.PlayerLocation = player->GetActorLocation();
+        snapshot.PlayerVelocity = player->GetVelocity();
+        snapshot.PlayerRadius = playerCapsule->GetScaledCapsuleRadius();
+        snapshot.PlayerHalfHeight = playerCapsule->GetScaledCapsuleHalfHeight_WithoutHemisphere();
+
+        if (const ASoftDesignTrainingMainCharacter* mainCharacter = Cast<ASoftDesignTrainingMainCharacter>(player))
+            snapshot.PlayerPoweredUp = mainCharacter->IsPoweredUp();
+    }
+
+    snapshot.Collectibles.Reset();
+    snapshot.CollectibleLocations.Reset();
+    snapshot.CollectibleAvailable.Reset();
+    snapshot.CollectibleSlots.Reset();
+    if (const USDTCollectibleRegistry* registry = world->GetSubsystem<USDTCollectibleRegistry>())
+    {
+        const int32 slotCount = registry->GetSlotCount();
+        snapshot.Collectibles.Init(nullptr, slotCount);
+        snapshot.CollectibleLocations.Init(FVector::ZeroVector, slotCount);
+        snapshot.CollectibleAvailable.Init(false, slotCount);
+
+        for (const ASDTCollectible* collectible : registry->GetCollectibles())
+        {
+            const int32 slot = collectible->m_ReservationSlot;
+            snapshot.Collectibles[slot] = collectible;
+            snapshot.CollectibleLocations[slot] = collectible->GetActorLocation();
+            snapshot.CollectibleAvailable[slot] = registry->IsAvailable(collectible);
+            snapshot.CollectibleSlots.Add(collectible, slot);
+        }
+    }
+
+    // the hazard service knows the spawners from their lanes, no spawner actor is read
+    snapshot.SpawnerLocations.Reset();
+    snapshot.SpawnerShotVelocities.Reset();
+    snapshot.SpawnerNextShotTimes.Reset();
+    if (const USDTHazardSubsystem* hazards = world->GetSubsystem<USDTHazardSubsystem>())
+        hazards->GetSpawnerStates(snapshot.Time, snapshot.SpawnerLocations, snapshot.SpawnerShotVelocities, snapshot.SpawnerNextShotTimes);
+
+    snapshot.FleeLocations.Reset();
+    snapshot.FleeLocationPositions.Reset();
+    snapshot.FleeLocationVersion = 0;
+    if (const USDTFleeTable* fleeTable = world->GetSubsystem<USDTFleeTable>())
+    {
+        snapshot.FleeLocationVersion = fleeTable->GetFleeLocationVersion();
+        for (const ASDTFleeLocation* fleeLocation : fleeTable->GetFleeLocations())
+        {
+            snapshot.FleeLocations.Add(fleeLocation);
+            snapshot.FleeLocationPositions.Add(fleeLocation->GetActorLocation());
+        }
+    }
+}
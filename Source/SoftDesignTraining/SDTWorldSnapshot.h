@@ -0,0 +1,77 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/EngineBaseTypes.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "SDTWorldSnapshot.generated.h"
+
+class ASDTCollectible;
+class ASDTFleeLocation;
+
+/**
+ * State of the world shared by all the AI pawns, captured once per frame before the actors tick.
+ * A snapshot is never modified once published, so it can be read from any thread while the game thread captures the next one.
+ * The actor pointers are only identities: they must not be dereferenced outside of the game thread.
+ */
+struct SOFTDESIGNTRAINING_API FSDTWorldSnapshot
+{
+    uint64 Frame = 0;
+    float Time = 0.f;
+
+    // Player
+    AActor* Player = nullptr;
+    FVector PlayerLocation = FVector::ZeroVector;
+    FVector PlayerVelocity = FVector::ZeroVector;
+    float PlayerRadius = 0.f;
+    float PlayerHalfHeight = 0.f;
+    bool PlayerPoweredUp = false;
+
+    // Collectibles, indexed by their slot in the reservation table of the collectible registry
+    TArray<const ASDTCollectible*> Collectibles;
+    TArray<FVector> CollectibleLocations;
+    TBitArray<> CollectibleAvailable;
+    TMap<const ASDTCollectible*, int32> CollectibleSlots;
+
+    // Projectile spawners, in the order of the hazard lanes
+    TArray<FVector> SpawnerLocations;
+    TArray<FVector> SpawnerShotVelocities;
+    TArray<float> SpawnerNextShotTimes;
+
+    // Flee locations, in the order of the flee table
+    TArray<const ASDTFleeLocation*> FleeLocations;
+    TArray<FVector> FleeLocationPositions;
+    uint32 FleeLocationVersion = 0;
+
+    bool HasPlayer() const { return Player != nullptr; }
+    int32 FindCollectibleSlot(const ASDTCollectible* collectible) const;
+    bool IsCollectibleAvailable(const ASDTCollectible* collectible) const;
+};
+
+typedef TSharedPtr<const FSDTWorldSnapshot, ESPMode::ThreadSafe> FSDTWorldSnapshotPtr;
+
+/**
+ * Captures the world snapshot of every frame.
+ * The previous snapshots stay alive as long as someone holds them; their memory is reused once they are released.
+ */
+UCLASS()
+class SOFTDESIGNTRAINING_API USDTWorldSnapshotSubsystem : public UWorldSubsystem
+{
+    GENERATED_BODY()
+
+public:
+    virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+    virtual void Deinitialize() override;
+
+    // Snapshot of the current frame, null until the first frame of the world ticks
+    FSDTWorldSnapshotPtr GetSnapshot() const { return m_Snapshot; }
+
+private:
+    void OnWorldPreActorTick(UWorld* world, ELevelTick tickType, float deltaSeconds);
+    void Capture(FSDTWorldSnapshot& snapshot) const;
+
+    TSharedPtr<FSDTWorldSnapshot, ESPMode::ThreadSafe> m_Snapshot;
+    TSharedPtr<FSDTWorldSnapshot, ESPMode::ThreadSafe> m_PreviousSnapshot;
+    FDelegateHandle m_PreActorTickHandle;
+};
@@ -1,9 +1,20 @@
 // Copyright 1998-2015 Epic Games, Inc. All Rights Reserved.
 
 #include "SoftDesignTraining.h"
+#include "SDTUtils.h"
 
 
 IMPLEMENT_PRIMARY_GAME_MODULE(SoftDesignTrainingModuleImpl, SoftDesignTraining, "SoftDesignTraining");
 
 DEFINE_LOG_CATEGORY(LogSoftDesignTraining)
+
+void SoftDesignTrainingModuleImpl::StartupModule()
+{
+    SDTUtils::RegisterLOSCache();
+}
+
+void SoftDesignTrainingModuleImpl::ShutdownModule()
+{
+    SDTUtils::UnregisterLOSCache();
+}
  
\ No newline at end of file
@@ -9,6 +9,9 @@ DECLARE_LOG_CATEGORY_EXTERN(LogSoftDesignTraining, Log, All);
 
 class SoftDesignTrainingModuleImpl : public FDefaultGameModuleImpl
 {
+public:
+    virtual void StartupModule() override;
+    virtual void ShutdownModule() override;
 };
 
 #endif
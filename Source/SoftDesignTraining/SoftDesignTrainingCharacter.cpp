@@ -3,7 +3,8 @@
 #include "SoftDesignTrainingCharacter.h"
 #include "SoftDesignTraining.h"
 #include "SoftDesignTrainingMainCharacter.h"
-#include "SDTAIController.h"
+#include "SDTGameEvents.h"
+#include "SDTProjectileManager.h"
 #include "SDTProjectile.h"
 #include "SDTUtils.h"
 #include "DrawDebugHelpers.h"
@@ -21,6 +22,17 @@ void ASoftDesignTrainingCharacter::BeginPlay()
 
     GetCapsuleComponent()->OnComponentBeginOverlap.AddDynamic(this, &ASoftDesignTrainingCharacter::OnBeginOverlap);
     m_StartingPosition = GetActorLocation();
+
+    if (USDTProjectileManager* projectileManager = GetWorld()->GetSubsystem<USDTProjectileManager>())
+        projectileManager->RegisterPawn(this);
+}
+
+void ASoftDesignTrainingCharacter::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+    if (USDTProjectileManager* projectileManager = GetWorld()->GetSubsystem<USDTProjectileManager>())
+        projectileManager->UnregisterPawn(this);
+
+    Super::EndPlay(EndPlayReason);
 }
 
 void ASoftDesignTrainingCharacter::OnBeginOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComponent, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult)
@@ -49,8 +61,7 @@ void ASoftDesignTrainingCharacter::Die()
 {
     SetActorLocation(m_StartingPosition);
 
-    if (ASDTAIController* controller = Cast<ASDTAIController>(GetController()))
-    {
-        controller->AIStateInterrupted();
-    }
+    // the AI controllers interrupt their own pawn and stop chasing a dead player
+    if (USDTGameEvents* events = GetWorld()->GetSubsystem<USDTGameEvents>())
+        events->OnCharacterDied.Broadcast(this);
 }
@@ -13,6 +13,7 @@ public:
     ASoftDesignTrainingCharacter();
 
     virtual void BeginPlay() override;
+    virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
     virtual void OnCollectPowerUp() {};
     void Die();
 
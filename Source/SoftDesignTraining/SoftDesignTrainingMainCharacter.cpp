@@ -2,6 +2,7 @@
 
 #include "SoftDesignTrainingMainCharacter.h"
 #include "SoftDesignTraining.h"
+#include "SDTGameEvents.h"
 
 #include "Camera/CameraComponent.h"
 #include "GameFramework/SpringArmComponent.h"
@@ -42,6 +43,9 @@ void ASoftDesignTrainingMainCharacter::OnCollectPowerUp()
     GetMesh()->SetMaterial(0, m_PoweredUpMaterial);
 
     GetWorld()->GetTimerManager().SetTimer(m_PowerUpTimer, this, &ASoftDesignTrainingMainCharacter::OnPowerUpDone, m_PowerUpDuration, false);
+
+    if (USDTGameEvents* events = GetWorld()->GetSubsystem<USDTGameEvents>())
+        events->OnPowerUpChanged.Broadcast(this, true);
 }
 
 void ASoftDesignTrainingMainCharacter::OnPowerUpDone()
@@ -51,4 +55,7 @@ void ASoftDesignTrainingMainCharacter::OnPowerUpDone()
     GetMesh()->SetMaterial(0, nullptr);
 
     GetWorld()->GetTimerManager().ClearTimer(m_PowerUpTimer);
+
+    if (USDTGameEvents* events = GetWorld()->GetSubsystem<USDTGameEvents>())
+        events->OnPowerUpChanged.Broadcast(this, false);
 }